@@ -29,7 +29,9 @@
 #include "pointer.h"
 #include "singleton.h"
 
+#include <limits>
 #include <sstream>
+#include <unordered_map>
 
 
 namespace nsim2023
@@ -202,10 +204,18 @@ class ArrayMatcher
     bool Matches(std::size_t i) const;
 
   private:
+    /**
+     * Add the indices an element of a path matches.
+     * \param [in] element The element: "*", an index, a range "[min-max]",
+     *   or alternatives of these separated by '|'.
+     */
+    void Parse(std::string element);
 
     bool StringToUint32(std::string str, uint32_t* value) const;
 
     std::string m_element;
+    /** The inclusive ranges of matching indices. */
+    std::vector<std::pair<std::size_t, std::size_t>> m_ranges;
 
 };
 
@@ -213,64 +223,59 @@ ArrayMatcher::ArrayMatcher(std::string element)
     : m_element(element)
 {
     NS_LOG_FUNCTION(this << element);
+    Parse(element);
 }
 
-bool ArrayMatcher::Matches(std::size_t i) const
+void
+ArrayMatcher::Parse(std::string element)
 {
-    NS_LOG_FUNCTION(this << i);
-    if (m_element == "*")
+    NS_LOG_FUNCTION(this << element);
+    if (element == "*")
     {
-        NS_LOG_DEBUG("Array " << i << " matches *");
-        return true;
+        m_ranges.emplace_back(0, std::numeric_limits<std::size_t>::max());
+        return;
     }
     std::string::size_type tmp;
-    tmp = m_element.find('|');
+    tmp = element.find('|');
     if (tmp != std::string::npos)
     {
-        std::string left = m_element.substr(0, tmp - 0);
-        std::string right = m_element.substr(tmp + 1, m_element.size() - (tmp + 1));
-        ArrayMatcher matcher = ArrayMatcher(left);
-        if (matcher.Matches(i))
-        {
-            NS_LOG_DEBUG("Array " << i << " matches " << left);
-            return true;
-        }
-        matcher = ArrayMatcher(right);
-        if (matcher.Matches(i))
-        {
-            NS_LOG_DEBUG("Array " << i << " matches " << right);
-            return true;
-        }
-        NS_LOG_DEBUG("Array " << i << " does not match " << m_element);
-        return false;
+        Parse(element.substr(0, tmp - 0));
+        Parse(element.substr(tmp + 1, element.size() - (tmp + 1)));
+        return;
     }
-    std::string::size_type leftBracket = m_element.find('[');
-    std::string::size_type rightBracket = m_element.find(']');
-    std::string::size_type dash = m_element.find('-');
-    if (leftBracket == 0 && rightBracket == m_element.size() - 1 && dash > leftBracket &&
+    std::string::size_type leftBracket = element.find('[');
+    std::string::size_type rightBracket = element.find(']');
+    std::string::size_type dash = element.find('-');
+    if (leftBracket == 0 && rightBracket == element.size() - 1 && dash > leftBracket &&
         dash < rightBracket)
     {
-        std::string lowerBound = m_element.substr(leftBracket + 1, dash - (leftBracket + 1));
-        std::string upperBound = m_element.substr(dash + 1, rightBracket - (dash + 1));
+        std::string lowerBound = element.substr(leftBracket + 1, dash - (leftBracket + 1));
+        std::string upperBound = element.substr(dash + 1, rightBracket - (dash + 1));
         uint32_t min;
         uint32_t max;
-        if (StringToUint32(lowerBound, &min) && StringToUint32(upperBound, &max) && i >= min &&
-            i <= max)
+        if (StringToUint32(lowerBound, &min) && StringToUint32(upperBound, &max))
         {
-            NS_LOG_DEBUG("Array " << i << " matches " << m_element);
-            return true;
-        }
-        else
-        {
-            NS_LOG_DEBUG("Array " << i << " does not " << m_element);
-            return false;
+            m_ranges.emplace_back(min, max);
         }
+        return;
     }
     uint32_t value;
-    if (StringToUint32(m_element, &value) && i == value)
+    if (StringToUint32(element, &value))
     {
-        NS_LOG_DEBUG("Array " << i << " matches " << m_element);
-        return true;
+        m_ranges.emplace_back(value, value);
+    }
+}
+
+bool ArrayMatcher::Matches(std::size_t i) const
+{
+    NS_LOG_FUNCTION(this << i);
+    for (const auto& range : m_ranges)
+    {
+        if (i >= range.first && i <= range.second)
+        {
+            NS_LOG_DEBUG("Array " << i << " matches " << m_element);
+            return true;
+        }
     }
     NS_LOG_DEBUG("Array " << i << " does not match " << m_element);
     return false;
@@ -285,6 +290,176 @@ bool ArrayMatcher::StringToUint32(std::string str, uint32_t* value) const
     return !iss.bad() && !iss.fail();
 }
 
+/**
+ * A Config path split into segments, with what can be decided about each
+ * segment before meeting an object.
+ */
+struct PathProgram
+{
+    /** A pointer or object container attribute selected by a segment. */
+    struct AttributeStep
+    {
+        std::string name;                       //!< The attribute name.
+        Ptr<const AttributeAccessor> accessor;  //!< Its accessor.
+        bool gettable;                          //!< Whether it can be read directly.
+        bool container;                         //!< An object container, not a pointer.
+        /** The accessor of an object container which can be read in part. */
+        const ObjectPtrContainerAccessor* items;
+    };
+
+    /** The part of the path between two slashes. */
+    struct Segment
+    {
+        /** The text of the segment. */
+        std::string item;
+        /** Whether the path from here starts with "/Names". */
+        bool names;
+        /** Whether the segment is a "$" GetObject. */
+        bool getObject;
+        /** The TypeId of a "$" segment, if it is registered. */
+        TypeId tid;
+        /** Whether \c tid was found. */
+        bool tidFound;
+        /** The indices matched after an object container, parsed on first use. */
+        mutable std::unique_ptr<ArrayMatcher> index;
+        /** The attribute generation of \c steps. */
+        mutable uint64_t generation;
+        /** The attributes selected on each instance TypeId met so far. */
+        mutable std::vector<std::pair<uint16_t, std::vector<AttributeStep>>> steps;
+    };
+
+    /**
+     * Compile a path.
+     * \param [in] path The path.
+     */
+    PathProgram(std::string path);
+
+    /**
+     * Get the attributes a segment selects on a type.
+     * \param [in] segment The segment.
+     * \param [in] tid The instance TypeId.
+     * \return The pointer and object container attributes, in lookup order.
+     */
+    const std::vector<AttributeStep>& GetSteps(std::size_t segment, TypeId tid) const;
+
+    /**
+     * Get the indices a segment matches after an object container.
+     * \param [in] segment The segment.
+     * \return The matcher.
+     */
+    const ArrayMatcher& GetIndex(std::size_t segment) const;
+
+    /** The path as given. */
+    std::string path;
+    /** The path starting and ending with a '/'. */
+    std::string canonical;
+    /** The segments. */
+    std::vector<Segment> segments;
+};
+
+PathProgram::PathProgram(std::string path)
+    : path(path),
+      canonical(path)
+{
+    NS_LOG_FUNCTION(this << path);
+
+    // ensure that we start and end with a '/'
+    std::string::size_type tmp = canonical.find('/');
+    if (tmp != 0)
+    {
+        // no slash at start
+        canonical = "/" + canonical;
+    }
+    tmp = canonical.find_last_of('/');
+    if (tmp != (canonical.size() - 1))
+    {
+        // no slash at end
+        canonical = canonical + "/";
+    }
+
+    for (std::string::size_type start = 1; start < canonical.size();)
+    {
+        std::string::size_type next = canonical.find('/', start);
+        Segment segment;
+        segment.item = canonical.substr(start, next - start);
+        segment.names = segment.item.compare(0, 5, "Names") == 0;
+        segment.getObject = segment.item.find('$') == 0;
+        segment.tidFound =
+            segment.getObject && TypeId::LookupByNameFailSafe(segment.item.substr(1), &segment.tid);
+        segment.generation = ~0ULL;
+        segments.push_back(std::move(segment));
+        start = next + 1;
+    }
+}
+
+const std::vector<PathProgram::AttributeStep>&
+PathProgram::GetSteps(std::size_t i, TypeId instance) const
+{
+    NS_LOG_FUNCTION(this << i << instance);
+    const Segment& segment = segments[i];
+    uint64_t generation = TypeId::GetAttributeGeneration();
+    if (segment.generation != generation)
+    {
+        segment.steps.clear();
+        segment.generation = generation;
+    }
+    for (const auto& entry : segment.steps)
+    {
+        if (entry.first == instance.GetUid())
+        {
+            return entry.second;
+        }
+    }
+
+    std::vector<AttributeStep> steps;
+    TypeId tid;
+    TypeId nextTid = instance;
+    do
+    {
+        tid = nextTid;
+        for (std::size_t j = 0; j < tid.GetAttributeN(); j++)
+        {
+            struct TypeId::AttributeInformation info = tid.GetAttribute(j);
+            if (info.name != segment.item && segment.item != "*")
+            {
+                continue;
+            }
+            bool gettable = (info.flags & TypeId::ATTR_GET) && info.accessor->HasGetter();
+            // attempt to cast to a pointer checker.
+            if (dynamic_cast<const PointerChecker*>(PeekPointer(info.checker)) != nullptr)
+            {
+                steps.push_back({info.name, info.accessor, gettable, false, nullptr});
+            }
+            // attempt to cast to an object vector.
+            if (dynamic_cast<const ObjectPtrContainerChecker*>(PeekPointer(info.checker)) !=
+                nullptr)
+            {
+                auto items =
+                    dynamic_cast<const ObjectPtrContainerAccessor*>(PeekPointer(info.accessor));
+                steps.push_back({info.name, info.accessor, gettable, true, items});
+            }
+            // this could be anything else and we don't know what to do with it.
+            // So, we just ignore it.
+        }
+        nextTid = tid.GetParent();
+    } while (nextTid != tid);
+
+    segment.steps.emplace_back(instance.GetUid(), std::move(steps));
+    return segment.steps.back().second;
+}
+
+const ArrayMatcher&
+PathProgram::GetIndex(std::size_t i) const
+{
+    NS_LOG_FUNCTION(this << i);
+    const Segment& segment = segments[i];
+    if (!segment.index)
+    {
+        segment.index = std::make_unique<ArrayMatcher>(segment.item);
+    }
+    return *segment.index;
+}
+
 /**
  * Abstract class to parse Config paths into object references.
  */
@@ -292,7 +467,7 @@ class Resolver
 {
   public:
 
-    Resolver(std::string path);
+    Resolver(const PathProgram& program);
 
     virtual ~Resolver();
 
@@ -303,34 +478,44 @@ class Resolver
     void Resolve(Ptr<Object> root);
 
   private:
-    /** Ensure the Config path starts and ends with a '/'. */
-    void Canonicalize();
-
     /**
-     * Parse the next element in the Config path.
+     * Parse the next segment of the Config path.
      */
-    void DoResolve(std::string path, Ptr<Object> root);
+    void DoResolve(std::size_t segment, Ptr<Object> root);
 
-    void DoArrayResolve(std::string path, const ObjectPtrContainerValue& vector);
+    /**
+     * Parse the index segment following an object container attribute.
+     */
+    void DoArrayResolve(std::size_t segment,
+                        const PathProgram::AttributeStep& step,
+                        Ptr<Object> root);
 
     void DoResolveOne(Ptr<Object> object);
 
+    /** Append an item to the resolved path. */
+    void Push(const std::string& item);
+
+    /** Remove the last item of the resolved path. */
+    void Pop();
+
     std::string GetResolvedPath() const;
 
     virtual void DoOne(Ptr<Object> object, std::string path) = 0;
 
-    /** Current list of path tokens. */
-    std::vector<std::string> m_workStack;
-    /** The Config path. */
-    std::string m_path;
+    /** The length of the resolved path before each of its items. */
+    std::vector<std::size_t> m_workStack;
+    /** The resolved path. */
+    std::string m_resolved;
+    /** The compiled Config path. */
+    const PathProgram& m_program;
 
 }; // class Resolver
 
-Resolver::Resolver(std::string path)
-    : m_path(path)
+Resolver::Resolver(const PathProgram& program)
+    : m_resolved("/"),
+      m_program(program)
 {
-    NS_LOG_FUNCTION(this << path);
-    Canonicalize();
+    NS_LOG_FUNCTION(this << program.path);
 }
 
 Resolver::~Resolver()
@@ -339,45 +524,33 @@ Resolver::~Resolver()
 }
 
 void
-Resolver::Canonicalize()
+Resolver::Resolve(Ptr<Object> root)
 {
-    NS_LOG_FUNCTION(this);
+    NS_LOG_FUNCTION(this << root);
 
-    // ensure that we start and end with a '/'
-    std::string::size_type tmp = m_path.find('/');
-    if (tmp != 0)
-    {
-        // no slash at start
-        m_path = "/" + m_path;
-    }
-    tmp = m_path.find_last_of('/');
-    if (tmp != (m_path.size() - 1))
-    {
-        // no slash at end
-        m_path = m_path + "/";
-    }
+    DoResolve(0, root);
 }
 
 void
-Resolver::Resolve(Ptr<Object> root)
+Resolver::Push(const std::string& item)
 {
-    NS_LOG_FUNCTION(this << root);
+    m_workStack.push_back(m_resolved.size());
+    m_resolved += item;
+    m_resolved += '/';
+}
 
-    DoResolve(m_path, root);
+void
+Resolver::Pop()
+{
+    m_resolved.resize(m_workStack.back());
+    m_workStack.pop_back();
 }
 
 std::string
 Resolver::GetResolvedPath() const
 {
     NS_LOG_FUNCTION(this);
-
-    std::string fullPath = "/";
-    for (std::vector<std::string>::const_iterator i = m_workStack.begin(); i != m_workStack.end();
-         i++)
-    {
-        fullPath += *i + "/";
-    }
-    return fullPath;
+    return m_resolved;
 }
 
 void
@@ -390,13 +563,11 @@ Resolver::DoResolveOne(Ptr<Object> object)
 }
 
 void
-Resolver::DoResolve(std::string path, Ptr<Object> root)
+Resolver::DoResolve(std::size_t segment, Ptr<Object> root)
 {
-    NS_LOG_FUNCTION(this << path << root);
-    NS_ASSERT((path.find('/')) == 0);
-    std::string::size_type next = path.find('/', 1);
+    NS_LOG_FUNCTION(this << segment << root);
 
-    if (next == std::string::npos)
+    if (segment == m_program.segments.size())
     {
         //
         // If root is zero, we're beginning to see if we can use the object name
@@ -412,8 +583,8 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
         }
         return;
     }
-    std::string item = path.substr(1, next - 1);
-    std::string pathLeft = path.substr(next, path.size() - next);
+    const PathProgram::Segment& current = m_program.segments[segment];
+    const std::string& item = current.item;
 
     //
     // If root is zero, we're beginning to see if we can use the object name
@@ -422,16 +593,12 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
     // the root of the "/Names" namespace, so we just ignore it and move on to
     // the next segment.
     //
-    if (!root)
+    if (!root && current.names)
     {
-        std::string::size_type offset = path.find("/Names");
-        if (offset == 0)
-        {
-            m_workStack.push_back(item);
-            DoResolve(pathLeft, root);
-            m_workStack.pop_back();
-            return;
-        }
+        Push(item);
+        DoResolve(segment + 1, root);
+        Pop();
+        return;
     }
 
     //
@@ -444,9 +611,9 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
     if (namedObject)
     {
         NS_LOG_DEBUG("Name system resolved item = " << item << " to " << namedObject);
-        m_workStack.push_back(item);
-        DoResolve(pathLeft, namedObject);
-        m_workStack.pop_back();
+        Push(item);
+        DoResolve(segment + 1, namedObject);
+        Pop();
         return;
     }
 
@@ -461,85 +628,63 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
     {
         return;
     }
-    std::string::size_type dollarPos = item.find('$');
-    if (dollarPos == 0)
+    if (current.getObject)
     {
         // This is a call to GetObject
-        std::string tidString = item.substr(1, item.size() - 1);
-        NS_LOG_DEBUG("GetObject=" << tidString << " on path=" << GetResolvedPath());
-        TypeId tid = TypeId::LookupByName(tidString);
+        NS_LOG_DEBUG("GetObject=" << item.substr(1) << " on path=" << GetResolvedPath());
+        // An unknown type fails here, as it always has
+        TypeId tid = current.tidFound ? current.tid : TypeId::LookupByName(item.substr(1));
         Ptr<Object> object = root->GetObject<Object>(tid);
         if (!object)
         {
-            NS_LOG_DEBUG("GetObject (" << tidString << ") failed on path=" << GetResolvedPath());
+            NS_LOG_DEBUG("GetObject (" << item.substr(1)
+                                       << ") failed on path=" << GetResolvedPath());
             return;
         }
-        m_workStack.push_back(item);
-        DoResolve(pathLeft, object);
-        m_workStack.pop_back();
+        Push(item);
+        DoResolve(segment + 1, object);
+        Pop();
     }
     else
     {
         // this is a normal attribute.
-        TypeId tid;
-        TypeId nextTid = root->GetInstanceTypeId();
         bool foundMatch = false;
-
-        do
+        for (const PathProgram::AttributeStep& step :
+             m_program.GetSteps(segment, root->GetInstanceTypeId()))
         {
-            tid = nextTid;
-
-            for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+            if (!step.container)
             {
-                struct TypeId::AttributeInformation info;
-                info = tid.GetAttribute(i);
-                if (info.name != item && item != "*")
-                {
-                    continue;
-                }
-                // attempt to cast to a pointer checker.
-                const PointerChecker* pChecker =
-                    dynamic_cast<const PointerChecker*>(PeekPointer(info.checker));
-                if (pChecker != nullptr)
+                NS_LOG_DEBUG("GetAttribute(ptr)=" << step.name << " on path=" << GetResolvedPath());
+                PointerValue pValue;
+                if (!step.gettable || !step.accessor->Get(PeekPointer(root), pValue))
                 {
-                    NS_LOG_DEBUG("GetAttribute(ptr)=" << info.name
-                                                      << " on path=" << GetResolvedPath());
-                    PointerValue pValue;
-                    root->GetAttribute(info.name, pValue);
-                    Ptr<Object> object = pValue.Get<Object>();
-                    if (!object)
-                    {
-                        NS_LOG_ERROR("Requested object name=\"" << item << "\" exists on path=\""
-                                                                << GetResolvedPath()
-                                                                << "\""
-                                                                   " but is null.");
-                        continue;
-                    }
-                    foundMatch = true;
-                    m_workStack.push_back(info.name);
-                    DoResolve(pathLeft, object);
-                    m_workStack.pop_back();
+                    // Let ObjectBase::GetAttribute raise any errors
+                    root->GetAttribute(step.name, pValue);
                 }
-                // attempt to cast to an object vector.
-                const ObjectPtrContainerChecker* vectorChecker =
-                    dynamic_cast<const ObjectPtrContainerChecker*>(PeekPointer(info.checker));
-                if (vectorChecker != nullptr)
+                Ptr<Object> object = pValue.Get<Object>();
+                if (!object)
                 {
-                    NS_LOG_DEBUG("GetAttribute(vector)=" << info.name << " on path="
-                                                         << GetResolvedPath() << pathLeft);
-                    foundMatch = true;
-                    ObjectPtrContainerValue vector;
-                    root->GetAttribute(info.name, vector);
-                    m_workStack.push_back(info.name);
-                    DoArrayResolve(pathLeft, vector);
-                    m_workStack.pop_back();
+                    NS_LOG_ERROR("Requested object name=\"" << item << "\" exists on path=\""
+                                                            << GetResolvedPath()
+                                                            << "\""
+                                                               " but is null.");
+                    continue;
                 }
-                // this could be anything else and we don't know what to do with it.
-                // So, we just ignore it.
+                foundMatch = true;
+                Push(step.name);
+                DoResolve(segment + 1, object);
+                Pop();
             }
-
-            nextTid = tid.GetParent();
-        } while (nextTid != tid);
+            else
+            {
+                NS_LOG_DEBUG("GetAttribute(vector)=" << step.name
+                                                     << " on path=" << GetResolvedPath());
+                foundMatch = true;
+                Push(step.name);
+                DoArrayResolve(segment + 1, step, root);
+                Pop();
+            }
+        }
 
         if (!foundMatch)
         {
@@ -551,32 +696,42 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
 }
 
 void
-Resolver::DoArrayResolve(std::string path, const ObjectPtrContainerValue& container)
+Resolver::DoArrayResolve(std::size_t segment,
+                         const PathProgram::AttributeStep& step,
+                         Ptr<Object> root)
 {
-    NS_LOG_FUNCTION(this << path << &container);
-    NS_ASSERT(path != "");
-    NS_ASSERT((path.find('/')) == 0);
-    std::string::size_type next = path.find('/', 1);
-    if (next == std::string::npos)
+    NS_LOG_FUNCTION(this << segment << step.name << root);
+    if (segment == m_program.segments.size())
     {
         return;
     }
-    std::string item = path.substr(1, next - 1);
-    std::string pathLeft = path.substr(next, path.size() - next);
 
-    ArrayMatcher matcher = ArrayMatcher(item);
-    ObjectPtrContainerValue::Iterator it;
-    for (it = container.Begin(); it != container.End(); ++it)
+    const ArrayMatcher& matcher = m_program.GetIndex(segment);
+    std::vector<std::pair<std::size_t, Ptr<Object>>> items;
+    if (!step.gettable || step.items == nullptr ||
+        !step.items->GetIf(
+            PeekPointer(root),
+            [&matcher](std::size_t i) { return matcher.Matches(i); },
+            &items))
     {
-        if (matcher.Matches((*it).first))
+        // Let ObjectBase::GetAttribute raise any errors
+        ObjectPtrContainerValue container;
+        root->GetAttribute(step.name, container);
+        items.clear();
+        for (auto it = container.Begin(); it != container.End(); ++it)
         {
-            std::ostringstream oss;
-            oss << (*it).first;
-            m_workStack.push_back(oss.str());
-            DoResolve(pathLeft, (*it).second);
-            m_workStack.pop_back();
+            if (matcher.Matches(it->first))
+            {
+                items.push_back(*it);
+            }
         }
     }
+    for (const auto& item : items)
+    {
+        Push(std::to_string(item.first));
+        DoResolve(segment + 1, item.second);
+        Pop();
+    }
 }
 
 /**
@@ -602,6 +757,17 @@ class ConfigImpl : public Singleton<ConfigImpl>
     void Disconnect(std::string path, const CallbackBase& cb);
     /** \copydoc ns3::Config::LookupMatches() */
     MatchContainer LookupMatches(std::string path);
+    /** \copydoc ns3::Config::CompilePath() */
+    CompiledPath CompilePath(std::string path);
+    /** \copydoc ns3::Config::LookupMatches(const CompiledPath&) */
+    MatchContainer LookupMatches(const CompiledPath& path);
+
+    /** \copydoc ns3::Config::EnableMatchCache() */
+    void EnableMatchCache();
+    /** \copydoc ns3::Config::DisableMatchCache() */
+    void DisableMatchCache();
+    /** \copydoc ns3::Config::InvalidateMatchCache() */
+    void InvalidateMatchCache();
 
     /** \copydoc ns3::Config::RegisterRootNamespaceObject() */
     void RegisterRootNamespaceObject(Ptr<Object> obj);
@@ -623,12 +789,60 @@ class ConfigImpl : public Singleton<ConfigImpl>
      */
     void ParsePath(std::string path, std::string* root, std::string* leaf) const;
 
+    /**
+     * Get the program of a path, compiling it the first time.
+     * \param [in] path The path.
+     * \return The program.
+     */
+    std::shared_ptr<const PathProgram> Compile(std::string path);
+
+    /**
+     * Find the objects a program matches, or remember them.
+     * \param [in] program The program.
+     * \return The matching objects.
+     */
+    MatchContainer LookupMatches(const PathProgram& program);
+
+    /**
+     * Invalidate the remembered matches if setting an attribute of the
+     * matched objects may have changed the object graph.
+     * \param [in] container The objects.
+     * \param [in] leaf The attribute name.
+     */
+    void NotifySet(const MatchContainer& container, std::string leaf);
+
+    /**
+     * Get a number which changes whenever the object graph changes in a
+     * way the Config system can see.  All its terms only grow.
+     * \return The graph generation.
+     */
+    uint64_t GetGraphGeneration() const;
+
     /** Container type to hold the root Config path tokens. */
     typedef std::vector<Ptr<Object>> Roots;
 
     /** The list of Config path roots. */
     Roots m_roots;
 
+    /** The objects matched by a path, with the graph generation they belong to. */
+    struct Matches
+    {
+        uint64_t generation;              //!< The graph generation.
+        std::vector<Ptr<Object>> objects; //!< The objects.
+        std::vector<std::string> contexts; //!< The path of each object.
+    };
+
+    /** The compiled paths, by path. */
+    std::unordered_map<std::string, std::shared_ptr<const PathProgram>> m_programs;
+    /** The remembered matches, by canonical path. */
+    std::unordered_map<std::string, Matches> m_matches;
+    /** Whether matches are remembered. */
+    bool m_matchCacheEnabled{false};
+    /** Incremented by changes to the object graph seen by Config only. */
+    uint64_t m_generation{0};
+    /** The most programs or remembered matches kept before they are forgotten. */
+    static constexpr std::size_t MAX_CACHED = 4096;
+
 }; // class ConfigImpl
 
 void
@@ -653,6 +867,7 @@ ConfigImpl::Set(std::string path, const AttributeValue& value)
     ParsePath(path, &root, &leaf);
     MatchContainer container = LookupMatches(root);
     container.Set(leaf, value);
+    NotifySet(container, leaf);
 }
 
 bool
@@ -664,7 +879,9 @@ ConfigImpl::SetFailSafe(std::string path, const AttributeValue& value)
     std::string leaf;
     ParsePath(path, &root, &leaf);
     MatchContainer container = LookupMatches(root);
-    return container.SetFailSafe(leaf, value);
+    bool ok = container.SetFailSafe(leaf, value);
+    NotifySet(container, leaf);
+    return ok;
 }
 
 bool
@@ -731,12 +948,65 @@ MatchContainer
 ConfigImpl::LookupMatches(std::string path)
 {
     NS_LOG_FUNCTION(this << path);
+    return LookupMatches(*Compile(path));
+}
+
+CompiledPath
+ConfigImpl::CompilePath(std::string path)
+{
+    NS_LOG_FUNCTION(this << path);
+    CompiledPath compiled;
+    compiled.m_program = Compile(path);
+    return compiled;
+}
+
+MatchContainer
+ConfigImpl::LookupMatches(const CompiledPath& path)
+{
+    NS_LOG_FUNCTION(this << path.GetPath());
+    NS_ABORT_MSG_IF(!path.m_program, "Config::LookupMatches(): the path was not compiled");
+    return LookupMatches(*path.m_program);
+}
+
+std::shared_ptr<const PathProgram>
+ConfigImpl::Compile(std::string path)
+{
+    NS_LOG_FUNCTION(this << path);
+    auto it = m_programs.find(path);
+    if (it != m_programs.end())
+    {
+        return it->second;
+    }
+    if (m_programs.size() >= MAX_CACHED)
+    {
+        m_programs.clear();
+    }
+    auto program = std::make_shared<const PathProgram>(path);
+    m_programs.emplace(path, program);
+    return program;
+}
+
+MatchContainer
+ConfigImpl::LookupMatches(const PathProgram& program)
+{
+    NS_LOG_FUNCTION(this << program.path);
+
+    uint64_t generation = GetGraphGeneration();
+    if (m_matchCacheEnabled)
+    {
+        auto it = m_matches.find(program.canonical);
+        if (it != m_matches.end() && it->second.generation == generation)
+        {
+            NS_LOG_DEBUG("remembered " << it->second.objects.size() << " matches");
+            return MatchContainer(it->second.objects, it->second.contexts, program.path);
+        }
+    }
 
     class LookupMatchesResolver : public Resolver
     {
       public:
-        LookupMatchesResolver(std::string path)
-            : Resolver(path)
+        LookupMatchesResolver(const PathProgram& program)
+            : Resolver(program)
         {
         }
 
@@ -748,7 +1018,7 @@ ConfigImpl::LookupMatches(std::string path)
 
         std::vector<Ptr<Object>> m_objects;
         std::vector<std::string> m_contexts;
-    } resolver = LookupMatchesResolver(path);
+    } resolver = LookupMatchesResolver(program);
 
     for (Roots::const_iterator i = m_roots.begin(); i != m_roots.end(); i++)
     {
@@ -762,7 +1032,74 @@ ConfigImpl::LookupMatches(std::string path)
     //
     resolver.Resolve(nullptr);
 
-    return MatchContainer(resolver.m_objects, resolver.m_contexts, path);
+    // Stamped with the generation before resolving, so changes made by the
+    // attribute getters we called invalidate the result
+    if (m_matchCacheEnabled)
+    {
+        if (m_matches.size() >= MAX_CACHED)
+        {
+            m_matches.clear();
+        }
+        m_matches[program.canonical] = {generation, resolver.m_objects, resolver.m_contexts};
+    }
+    return MatchContainer(resolver.m_objects, resolver.m_contexts, program.path);
+}
+
+void
+ConfigImpl::NotifySet(const MatchContainer& container, std::string leaf)
+{
+    NS_LOG_FUNCTION(this << leaf);
+    if (!m_matchCacheEnabled || m_matches.empty())
+    {
+        return;
+    }
+    // The leaf compiles to a single segment selecting the same attributes
+    std::shared_ptr<const PathProgram> program = Compile(leaf);
+    TypeId last;
+    for (const Ptr<Object>& object : container)
+    {
+        TypeId tid = object->GetInstanceTypeId();
+        if (tid == last)
+        {
+            continue;
+        }
+        last = tid;
+        if (!program->segments.empty() && !program->GetSteps(0, tid).empty())
+        {
+            NS_LOG_DEBUG("setting " << leaf << " on " << tid << " changes the object graph");
+            m_generation++;
+            return;
+        }
+    }
+}
+
+uint64_t
+ConfigImpl::GetGraphGeneration() const
+{
+    return m_generation + Names::GetGeneration() + Object::GetAggregationGeneration();
+}
+
+void
+ConfigImpl::EnableMatchCache()
+{
+    NS_LOG_FUNCTION(this);
+    m_matchCacheEnabled = true;
+}
+
+void
+ConfigImpl::DisableMatchCache()
+{
+    NS_LOG_FUNCTION(this);
+    m_matchCacheEnabled = false;
+    m_matches.clear();
+}
+
+void
+ConfigImpl::InvalidateMatchCache()
+{
+    NS_LOG_FUNCTION(this);
+    m_generation++;
+    m_matches.clear();
 }
 
 void
@@ -770,6 +1107,7 @@ ConfigImpl::RegisterRootNamespaceObject(Ptr<Object> obj)
 {
     NS_LOG_FUNCTION(this << obj);
     m_roots.push_back(obj);
+    m_generation++;
 }
 
 void
@@ -782,6 +1120,7 @@ ConfigImpl::UnregisterRootNamespaceObject(Ptr<Object> obj)
         if (*i == obj)
         {
             m_roots.erase(i);
+            m_generation++;
             return;
         }
     }
@@ -951,6 +1290,53 @@ LookupMatches(std::string path)
     return ConfigImpl::Get()->LookupMatches(path);
 }
 
+CompiledPath::CompiledPath()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+std::string
+CompiledPath::GetPath() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_program ? m_program->path : "";
+}
+
+CompiledPath
+CompilePath(std::string path)
+{
+    NS_LOG_FUNCTION(path);
+    return ConfigImpl::Get()->CompilePath(path);
+}
+
+MatchContainer
+LookupMatches(const CompiledPath& path)
+{
+    NS_LOG_FUNCTION(path.GetPath());
+    return ConfigImpl::Get()->LookupMatches(path);
+}
+
+void
+EnableMatchCache()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    ConfigImpl::Get()->EnableMatchCache();
+}
+
+void
+DisableMatchCache()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    ConfigImpl::Get()->DisableMatchCache();
+}
+
+void
+InvalidateMatchCache()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    ConfigImpl::Get()->InvalidateMatchCache();
+}
+
 void
 RegisterRootNamespaceObject(Ptr<Object> obj)
 {
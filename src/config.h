@@ -24,6 +24,7 @@
 
 #include "ptr.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -144,6 +145,62 @@ class MatchContainer
 
 MatchContainer LookupMatches(std::string path);
 
+class ConfigImpl;
+struct PathProgram;
+
+/**
+ * A Config path compiled into a program of segment matchers.
+ *
+ * The path is split and its "$" TypeIds are looked up once, and every
+ * segment remembers which attributes it selects on each type it meets,
+ * so resolving the path again does none of that work.
+ */
+class CompiledPath
+{
+  public:
+    CompiledPath();
+
+    /** \return The path this program was compiled from. */
+    std::string GetPath() const;
+
+  private:
+    friend class ConfigImpl;
+
+    /** The program, shared by the copies of this path. */
+    std::shared_ptr<const PathProgram> m_program;
+};
+
+/**
+ * Compile a path of objects, as given to LookupMatches, for reuse.
+ * \param [in] path The path.
+ * \return The compiled path.
+ */
+CompiledPath CompilePath(std::string path);
+
+/**
+ * Find the objects a compiled path matches.
+ * \param [in] path The compiled path.
+ * \return The matching objects.
+ */
+MatchContainer LookupMatches(const CompiledPath& path);
+
+/**
+ * Remember the objects every path matches until the object graph changes.
+ *
+ * Aggregation, the object name service, the root namespace objects and
+ * Config::Set on pointer or object container attributes invalidate the
+ * remembered matches.  Changes the Config system cannot see, such as an
+ * object added to a container attribute, need InvalidateMatchCache().
+ * The remembered matches hold references to their objects.
+ */
+void EnableMatchCache();
+
+/** Stop remembering matches, and forget those remembered. */
+void DisableMatchCache();
+
+/** Forget the remembered matches. */
+void InvalidateMatchCache();
+
 /**
  * Each root object is used during path matching as the root of the path by 
  * Config::Connect, and Config::Set.
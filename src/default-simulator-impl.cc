@@ -133,6 +133,8 @@ DefaultSimulatorImpl::ProcessOneEvent()
     NS_ASSERT(next.key.m_ts >= m_currentTs);
     m_unscheduledEvents--;
     m_eventCount++;
+    m_telemetry.RecordExecute(next.impl->IsCancelled());
+    m_telemetry.Poll(next.key.m_ts);
 
     NS_LOG_LOGIC("handle " << next.key.m_ts);
     m_currentTs = next.key.m_ts;
@@ -176,6 +178,7 @@ DefaultSimulatorImpl::ProcessEventsWithContext()
         ev.key.m_uid = m_uid;
         m_uid++;
         m_unscheduledEvents++;
+        m_telemetry.RecordInsert(m_currentTs, ev.key.m_ts);
         m_events->Insert(ev);
     }
 }
@@ -233,6 +236,7 @@ DefaultSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
     ev.key.m_uid = m_uid;
     m_uid++;
     m_unscheduledEvents++;
+    m_telemetry.RecordInsert(m_currentTs, ev.key.m_ts);
     m_events->Insert(ev);
     return EventId(event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
@@ -252,6 +256,7 @@ DefaultSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay, E
         ev.key.m_uid = m_uid;
         m_uid++;
         m_unscheduledEvents++;
+        m_telemetry.RecordInsert(m_currentTs, ev.key.m_ts);
         m_events->Insert(ev);
     }
     else
@@ -336,6 +341,7 @@ DefaultSimulatorImpl::Remove(const EventId& id)
     event.key.m_context = id.GetContext();
     event.key.m_uid = id.GetUid();
     m_events->Remove(event);
+    m_telemetry.RecordRemove();
     event.impl->Cancel();
     // whenever we remove an event from the event list, we have to unref it.
     event.impl->Unref();
@@ -349,6 +355,10 @@ DefaultSimulatorImpl::Cancel(const EventId& id)
     if (!IsExpired(id))
     {
         id.PeekEventImpl()->Cancel();
+        if (id.GetUid() != EventId::UID::DESTROY)
+        {
+            m_telemetry.RecordCancel();
+        }
     }
 }
 
@@ -402,5 +412,18 @@ DefaultSimulatorImpl::GetEventCount() const
     return m_eventCount;
 }
 
+SchedulerTelemetry::Snapshot
+DefaultSimulatorImpl::GetTelemetry() const
+{
+    return m_telemetry.GetSnapshot(m_currentTs);
+}
+
+void
+DefaultSimulatorImpl::SetTelemetryOutput(const std::string& filename, const Time& interval)
+{
+    NS_LOG_FUNCTION(this << filename << interval);
+    m_telemetry.SetOutput(filename, interval);
+}
+
 }
 
@@ -22,6 +22,7 @@
 #ifndef DEFAULT_SIMULATOR_IMPL_H
 #define DEFAULT_SIMULATOR_IMPL_H
 
+#include "scheduler-telemetry.h"
 #include "simulator-impl.h"
 
 #include <list>
@@ -74,6 +75,8 @@ class DefaultSimulatorImpl : public SimulatorImpl
     uint32_t GetSystemId() const override;
     uint32_t GetContext() const override;
     uint64_t GetEventCount() const override;
+    SchedulerTelemetry::Snapshot GetTelemetry() const override;
+    void SetTelemetryOutput(const std::string& filename, const Time& interval) override;
 
   private:
     void DoDispose() override;
@@ -130,6 +133,9 @@ class DefaultSimulatorImpl : public SimulatorImpl
      */
     int m_unscheduledEvents;
 
+    /** Event queue counters and histograms. */
+    SchedulerTelemetry m_telemetry;
+
     /** Main execution thread. */
     std::thread::id m_mainThreadId;
 };
@@ -136,6 +136,8 @@ void sigHandler(int sig)
 void FlushStreams()
 {
     NS_LOG_FUNCTION_NOARGS();
+    LogAsyncFlush();
+
     std::list<std::ostream*>** pl = PeekStreamList();
     if (*pl == nullptr)
     {
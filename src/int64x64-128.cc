@@ -64,6 +64,25 @@ uint128_t int64x64_t::Umul(const uint128_t a, const uint128_t b)
     uint128_t aH = (a >> 64) & HP_MASK_LO;
     uint128_t bH = (b >> 64) & HP_MASK_LO;
 
+    // Fast paths, with the same result as the general case below:
+    // an integer operand (typically a Time scaled by a factor) needs
+    // only the two products by the other operand, and two pure fractions
+    // only the high half of the product of the fractions.
+    if (aL == 0 || bL == 0)
+    {
+        uint128_t n = (aL == 0) ? aH : bH;
+        uint128_t xL = (aL == 0) ? bL : aL;
+        uint128_t xH = (aL == 0) ? bH : aH;
+        uint128_t hi = n * xH;
+        NS_ABORT_MSG_IF((hi & HP_MASK_HI) != 0,
+                        "High precision 128 bits multiplication error: multiplication overflow.");
+        return (hi << 64) + n * xL;
+    }
+    if (aH == 0 && bH == 0)
+    {
+        return (aL * bL) >> 64;
+    }
+
     uint128_t result;
     uint128_t hiPart;
     uint128_t loPart;
@@ -110,6 +129,31 @@ void int64x64_t::Div(const int64x64_t& o)
 
 uint128_t int64x64_t::Udiv(const uint128_t a, const uint128_t b)
 {
+    // The result is floor (a x 2^64 / b). A few common divisors give it
+    // directly, without the bit by bit long division below:
+    //  - a power of two is a shift,
+    //  - an integer divisor n gives floor (a / n),
+    //  - if a / b leaves a remainder below 2^64, the fraction is a single
+    //    128 by 128 bits division of the shifted remainder.
+    if (b != 0 && (b & (b - 1)) == 0)
+    {
+        int log2 = (b >> 64) ? 64 + __builtin_ctzll((uint64_t)(b >> 64))
+                             : __builtin_ctzll((uint64_t)b);
+        return (log2 >= 64) ? a >> (log2 - 64) : a << (64 - log2);
+    }
+    if ((b & HP_MASK_LO) == 0)
+    {
+        return a / (b >> 64);
+    }
+    {
+        uint128_t quo = a / b;
+        uint128_t rem = a % b;
+        if ((rem >> 64) == 0)
+        {
+            return (quo << 64) + (rem << 64) / b;
+        }
+    }
+
     uint128_t rem = a;
     uint128_t den = b;
     uint128_t quo = rem / den;
@@ -26,6 +26,7 @@
 #define INT64X64_128_H
 
 #include <cmath> // pow
+#include <cstring>
 #include <stdint.h>
 
 #if defined(HAVE___UINT128_T) && !defined(HAVE_UINT128_T)
@@ -77,10 +78,45 @@ class int64x64_t
     {
     }
 
+    /**
+     * Construct from a double.
+     *
+     * A finite double is exactly m x 2^e with a 53-bit mantissa m, so the
+     * Q64.64 value is m shifted by e + 64, rounded half up on the bits
+     * shifted out. This gives the same result as the long double
+     * conversion without going through the x87 unit. Non-finite and
+     * out-of-range values still use the long double conversion.
+     */
     inline int64x64_t(const double value)
     {
-        const int64x64_t tmp((long double)value);
-        _v = tmp._v;
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        const int exponent = static_cast<int>((bits >> 52) & 0x7ff);
+        const int shift = exponent - 1075 + 64;
+        if (exponent == 0x7ff || shift > 74)
+        {
+            const int64x64_t tmp((long double)value);
+            _v = tmp._v;
+            return;
+        }
+        uint64_t mantissa = bits & 0xfffffffffffffULL;
+        if (exponent != 0)
+        {
+            mantissa |= 1ULL << 52;
+        }
+        if (shift >= 0)
+        {
+            _v = (int128_t)((uint128_t)mantissa << shift);
+        }
+        else if (shift > -64)
+        {
+            _v = (mantissa + (1ULL << (-shift - 1))) >> -shift;
+        }
+        else
+        {
+            _v = 0;
+        }
+        _v = (bits >> 63) ? -_v : _v;
     }
 
     inline int64x64_t(const long double value)
@@ -0,0 +1,619 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#include "log-async.h"
+
+#include "node-printer.h"
+#include "simulator.h"
+#include "time-printer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+
+namespace nsim2023
+{
+
+namespace internal
+{
+
+std::atomic<bool> g_logAsync(false);
+
+} // namespace internal
+
+namespace
+{
+
+/** Kinds and prefixes of a record. */
+enum LogRecordFlags : uint32_t
+{
+    RECORD_FUNCTION = 0x01,     //!< NS_LOG_FUNCTION: `Name:function(parameters)`
+    RECORD_TIME = 0x02,         //!< Time prefix, from LogRecordHeader::time
+    RECORD_NODE = 0x04,         //!< Node prefix, from LogRecordHeader::context
+    RECORD_FUNC_PREFIX = 0x08,  //!< `Name:function(): ` prefix
+    RECORD_LEVEL_PREFIX = 0x10, //!< `[LEVEL] ` prefix
+};
+
+/** The fixed part of a record, followed by its items. */
+struct LogRecordHeader
+{
+    uint32_t size;                 //!< Size of the record, header included
+    uint32_t flags;                //!< LogRecordFlags
+    const LogComponent* component; //!< Component of the statement
+    const char* function;          //!< Enclosing function
+    int64_t time;                  //!< Simulation time step
+    uint32_t context;              //!< Simulation context
+    uint32_t level;                //!< Level of the statement
+};
+
+/**
+ * Single producer, single consumer ring of records.  The producer is the
+ * thread owning the ring, the consumer whoever holds the drain mutex.
+ * In the flight recorder mode the producer also drops the oldest records,
+ * and both sides take the lock of the ring.
+ */
+class LogRing
+{
+  public:
+    /** Create a ring of at least \p size bytes. */
+    explicit LogRing(std::size_t size)
+    {
+        std::size_t capacity = 1024;
+        while (capacity < size)
+        {
+            capacity *= 2;
+        }
+        // Not zeroed: the pages are only touched as the records arrive
+        m_buffer.reset(new char[capacity]);
+        m_size = capacity;
+    }
+
+    /** \returns The size of the largest record the ring can take. */
+    std::size_t Capacity() const
+    {
+        return m_size;
+    }
+
+    /**
+     * Append a record.
+     * \returns \c false if there is not enough free space.
+     */
+    bool Write(const char* data, std::size_t size)
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        uint64_t tail = m_tail.load(std::memory_order_acquire);
+        if (m_size - (head - tail) < size)
+        {
+            return false;
+        }
+        std::size_t offset = head & (m_size - 1);
+        std::size_t first = std::min(size, m_size - offset);
+        std::memcpy(m_buffer.get() + offset, data, first);
+        std::memcpy(m_buffer.get(), data + first, size - first);
+        m_head.store(head + size, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Move the committed records to \p out.
+     * \returns \c true if there were any.
+     */
+    bool Read(std::vector<char>& out)
+    {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        std::size_t size = head - tail;
+        if (size == 0)
+        {
+            return false;
+        }
+        std::size_t offset = tail & (m_size - 1);
+        std::size_t first = std::min(size, m_size - offset);
+        std::size_t start = out.size();
+        out.resize(start + size);
+        std::memcpy(out.data() + start, m_buffer.get() + offset, first);
+        std::memcpy(out.data() + start + first, m_buffer.get(), size - first);
+        m_tail.store(head, std::memory_order_release);
+        return true;
+    }
+
+    /** Drop the oldest record; for the producer, with the ring locked. */
+    void DropOldest()
+    {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        // The size is the first field of the record, maybe split by the wrap
+        uint32_t size;
+        char* bytes = reinterpret_cast<char*>(&size);
+        for (std::size_t i = 0; i < sizeof(size); i++)
+        {
+            bytes[i] = m_buffer[(tail + i) & (m_size - 1)];
+        }
+        m_tail.store(tail + size, std::memory_order_release);
+    }
+
+    /** Lock the ring. */
+    void Lock()
+    {
+        while (m_lock.test_and_set(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    /** Unlock the ring. */
+    void Unlock()
+    {
+        m_lock.clear(std::memory_order_release);
+    }
+
+  private:
+    std::unique_ptr<char[]> m_buffer; //!< The ring
+    std::size_t m_size;               //!< Size of the ring, a power of two
+    alignas(64) std::atomic<uint64_t> m_head{0}; //!< Bytes ever written
+    alignas(64) std::atomic<uint64_t> m_tail{0}; //!< Bytes ever read
+    std::atomic_flag m_lock = ATOMIC_FLAG_INIT;  //!< Lock of the flight recorder mode
+
+  public:
+    /** Set by the producer once it moved to a ring of another size. */
+    std::atomic<bool> abandoned{false};
+};
+
+/** State of the asynchronous backend. */
+struct LogAsyncState
+{
+    std::mutex control;                         //!< Serializes enabling and disabling
+    std::mutex ringsMutex;                      //!< Guards rings and ringSize
+    std::vector<std::unique_ptr<LogRing>> rings; //!< Rings of all threads so far
+    std::size_t ringSize{1 << 20};              //!< Size of new rings
+    std::atomic<uint64_t> generation{0};        //!< Incremented when ringSize changes
+    std::mutex drain;                           //!< Held by the consumer
+    std::vector<char> records;                  //!< Records being rendered
+    std::string out;                            //!< Rendered records
+    std::atomic<bool> flight{false};            //!< Flight recorder mode
+    std::thread worker;                         //!< The background thread
+    bool stop{false};                           //!< Ask the worker to finish
+    std::mutex wakeMutex;                       //!< Guards stop
+    std::condition_variable wake;               //!< Wakes the worker
+};
+
+/**
+ * Get the state of the asynchronous backend.  Never destroyed, so that it
+ * outlives the threads and static objects that may still log.
+ */
+LogAsyncState&
+GetState()
+{
+    static LogAsyncState* state = new LogAsyncState;
+    return *state;
+}
+
+/** The ring of the calling thread, once it has logged asynchronously. */
+thread_local LogRing* t_ring = nullptr;
+
+/** The LogAsyncState::generation of t_ring. */
+thread_local uint64_t t_generation = 0;
+
+/** Read a value of an item at \p pos and advance past it. */
+template <typename T>
+T
+Get(const char*& pos)
+{
+    T value;
+    std::memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+}
+
+/** Render one record, as the synchronous macros would print it. */
+void
+Render(const char* record, std::string& out)
+{
+    LogRecordHeader header;
+    std::memcpy(&header, record, sizeof(header));
+    if (header.flags & RECORD_TIME)
+    {
+        LogFormat::AppendTimeStep(out, header.time);
+        out += ' ';
+    }
+    if (header.flags & RECORD_NODE)
+    {
+        LogFormat::AppendContext(out, header.context);
+        out += ' ';
+    }
+    if (header.flags & RECORD_FUNCTION)
+    {
+        out += header.component->Name();
+        out += ':';
+        out += header.function;
+        out += '(';
+    }
+    else
+    {
+        if (header.flags & RECORD_FUNC_PREFIX)
+        {
+            out += header.component->Name();
+            out += ':';
+            out += header.function;
+            out += "(): ";
+        }
+        if (header.flags & RECORD_LEVEL_PREFIX)
+        {
+            out += '[';
+            out += LogComponent::GetLevelLabel((enum LogLevel)header.level);
+            out += "] ";
+        }
+    }
+    const char* pos = record + sizeof(header);
+    const char* end = record + header.size;
+    while (pos < end)
+    {
+        switch (static_cast<LogRecord::Tag>(*pos++))
+        {
+        case LogRecord::SIGNED:
+            LogFormat::AppendSigned(out, Get<int64_t>(pos));
+            break;
+        case LogRecord::UNSIGNED:
+            LogFormat::AppendUnsigned(out, Get<uint64_t>(pos));
+            break;
+        case LogRecord::FLOATING:
+            LogFormat::AppendDouble(out, Get<double>(pos));
+            break;
+        case LogRecord::CHARACTER:
+            out += Get<char>(pos);
+            break;
+        case LogRecord::POINTER:
+            LogFormat::AppendPointer(out, Get<const void*>(pos));
+            break;
+        case LogRecord::TEXT: {
+            uint32_t length = Get<uint32_t>(pos);
+            out.append(pos, length);
+            pos += length;
+            break;
+        }
+        }
+    }
+    if (header.flags & RECORD_FUNCTION)
+    {
+        out += ')';
+    }
+    out += '\n';
+}
+
+/**
+ * Render the pending records of all rings to std::clog, or discard them.
+ * \returns \c true if there were any.
+ */
+bool
+Drain(bool render = true)
+{
+    LogAsyncState& state = GetState();
+    std::lock_guard<std::mutex> drainLock(state.drain);
+    std::vector<LogRing*> rings;
+    {
+        std::lock_guard<std::mutex> lock(state.ringsMutex);
+        for (const auto& ring : state.rings)
+        {
+            rings.push_back(ring.get());
+        }
+    }
+    bool flight = state.flight.load(std::memory_order_relaxed);
+    bool any = false;
+    for (std::size_t i = 0; i < rings.size(); i++)
+    {
+        state.records.clear();
+        bool abandoned = rings[i]->abandoned.load(std::memory_order_acquire);
+        rings[i]->Lock();
+        bool read = rings[i]->Read(state.records);
+        rings[i]->Unlock();
+        if (abandoned)
+        {
+            std::lock_guard<std::mutex> lock(state.ringsMutex);
+            for (auto ring = state.rings.begin(); ring != state.rings.end(); ring++)
+            {
+                if (ring->get() == rings[i])
+                {
+                    state.rings.erase(ring);
+                    break;
+                }
+            }
+        }
+        if (!read || !render)
+        {
+            continue;
+        }
+        any = true;
+        if (flight)
+        {
+            state.out += "--- flight recorder, thread ";
+            LogFormat::AppendUnsigned(state.out, i);
+            state.out += " ---\n";
+        }
+        const char* pos = state.records.data();
+        const char* end = pos + state.records.size();
+        while (pos < end)
+        {
+            Render(pos, state.out);
+            pos += reinterpret_cast<const LogRecordHeader*>(pos)->size;
+        }
+    }
+    if (any)
+    {
+        std::clog.write(state.out.data(), state.out.size());
+        std::clog.flush();
+        state.out.clear();
+    }
+    return any;
+}
+
+/** Body of the background thread. */
+void
+Worker()
+{
+    LogAsyncState& state = GetState();
+    while (true)
+    {
+        if (Drain())
+        {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(state.wakeMutex);
+        if (state.stop)
+        {
+            break;
+        }
+        state.wake.wait_for(lock, std::chrono::milliseconds(1));
+    }
+    Drain();
+}
+
+/** Get the ring of the calling thread, creating it on first use. */
+LogRing*
+GetRing()
+{
+    LogAsyncState& state = GetState();
+    if (t_ring == nullptr || t_generation != state.generation.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(state.ringsMutex);
+        if (t_ring != nullptr)
+        {
+            // Left for Drain() to empty and delete
+            t_ring->abandoned.store(true, std::memory_order_release);
+        }
+        state.rings.emplace_back(new LogRing(state.ringSize));
+        t_ring = state.rings.back().get();
+        t_generation = state.generation.load(std::memory_order_relaxed);
+    }
+    return t_ring;
+}
+
+/** Commit a record to the ring of the calling thread. */
+void
+Commit(const std::vector<char>& record)
+{
+    LogRing* ring = GetRing();
+    bool flight = GetState().flight.load(std::memory_order_relaxed);
+    if (flight && record.size() > ring->Capacity())
+    {
+        return;
+    }
+    if (record.size() > ring->Capacity())
+    {
+        // Too large for any ring: write it out right away, after the
+        // pending records.
+        LogAsyncState& state = GetState();
+        Drain();
+        std::lock_guard<std::mutex> drainLock(state.drain);
+        std::string out;
+        Render(record.data(), out);
+        std::clog.write(out.data(), out.size());
+        std::clog.flush();
+        return;
+    }
+    if (flight)
+    {
+        // Keep the latest records only
+        ring->Lock();
+        while (!ring->Write(record.data(), record.size()))
+        {
+            ring->DropOldest();
+        }
+        ring->Unlock();
+        return;
+    }
+    while (!ring->Write(record.data(), record.size()))
+    {
+        // Full: wait for the background thread
+        GetState().wake.notify_one();
+        std::this_thread::yield();
+    }
+    if (!LogIsAsync())
+    {
+        // Turned off meanwhile, the background thread may be gone
+        Drain();
+    }
+}
+
+/** Set the size of new rings; with the control mutex held. */
+void
+SetRingSize(LogAsyncState& state, std::size_t ringSize)
+{
+    std::lock_guard<std::mutex> lock(state.ringsMutex);
+    if (ringSize != state.ringSize)
+    {
+        state.ringSize = ringSize;
+        state.generation++;
+    }
+    static bool atExit = (std::atexit(&LogDisableAsync), true);
+    (void)atExit;
+}
+
+/** Stop the background thread, if any; with the control mutex held. */
+void
+StopWorker(LogAsyncState& state)
+{
+    if (state.worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> wakeLock(state.wakeMutex);
+            state.stop = true;
+        }
+        state.wake.notify_one();
+        state.worker.join();
+    }
+}
+
+} // namespace
+
+void
+LogEnableAsync(std::size_t ringSize)
+{
+    LogAsyncState& state = GetState();
+    std::lock_guard<std::mutex> lock(state.control);
+    SetRingSize(state, ringSize);
+    state.flight = false;
+    if (!state.worker.joinable())
+    {
+        state.stop = false;
+        state.worker = std::thread(&Worker);
+    }
+    internal::g_logAsync.store(true, std::memory_order_relaxed);
+}
+
+void
+LogEnableFlightRecorder(std::size_t ringSize)
+{
+    LogAsyncState& state = GetState();
+    std::lock_guard<std::mutex> lock(state.control);
+    SetRingSize(state, ringSize);
+    StopWorker(state);
+    Drain();
+    state.flight = true;
+    internal::g_logAsync.store(true, std::memory_order_relaxed);
+}
+
+void
+LogDisableAsync()
+{
+    LogAsyncState& state = GetState();
+    std::lock_guard<std::mutex> lock(state.control);
+    internal::g_logAsync.store(false, std::memory_order_relaxed);
+    StopWorker(state);
+    // The flight recorder only speaks when asked to
+    Drain(!state.flight);
+    state.flight = false;
+}
+
+void
+LogAsyncFlush()
+{
+    Drain();
+}
+
+LogRecord::LogRecord(const LogComponent& component,
+                     const enum LogLevel level,
+                     const char* function,
+                     bool parameters)
+{
+    m_parameters = parameters;
+    m_staging.bytes.resize(sizeof(LogRecordHeader));
+
+    LogRecordHeader header;
+    header.flags = parameters ? RECORD_FUNCTION : 0;
+    header.component = &component;
+    header.function = function;
+    header.level = level;
+    header.time = 0;
+    header.context = 0;
+    if (!parameters && component.IsEnabled(LOG_PREFIX_FUNC))
+    {
+        header.flags |= RECORD_FUNC_PREFIX;
+    }
+    if (!parameters && component.IsEnabled(LOG_PREFIX_LEVEL))
+    {
+        header.flags |= RECORD_LEVEL_PREFIX;
+    }
+    TimePrinter timePrinter = component.IsEnabled(LOG_PREFIX_TIME) ? LogGetTimePrinter() : nullptr;
+    NodePrinter nodePrinter = component.IsEnabled(LOG_PREFIX_NODE) ? LogGetNodePrinter() : nullptr;
+    if ((timePrinter == nullptr || timePrinter == &DefaultTimePrinter) &&
+        (nodePrinter == nullptr || nodePrinter == &DefaultNodePrinter))
+    {
+        if (timePrinter != nullptr)
+        {
+            header.flags |= RECORD_TIME;
+            header.time = Simulator::Now().GetTimeStep();
+        }
+        if (nodePrinter != nullptr)
+        {
+            header.flags |= RECORD_NODE;
+            header.context = Simulator::GetContext();
+        }
+    }
+    else
+    {
+        // Custom printers can only run now
+        if (timePrinter != nullptr)
+        {
+            (*timePrinter)(Scratch());
+            Scratch() << " ";
+        }
+        if (nodePrinter != nullptr)
+        {
+            (*nodePrinter)(Scratch());
+            Scratch() << " ";
+        }
+        PutScratch();
+        ResetFormat(Scratch());
+    }
+    std::memcpy(m_staging.bytes.data(), &header, sizeof(header));
+}
+
+LogRecord::~LogRecord()
+{
+    std::vector<char>& bytes = m_staging.bytes;
+    uint32_t size = bytes.size();
+    std::memcpy(bytes.data() + offsetof(LogRecordHeader, size), &size, sizeof(size));
+    Commit(bytes);
+}
+
+void
+LogRecord::PutText(const char* text, std::size_t length)
+{
+    if (length == 0)
+    {
+        return;
+    }
+    std::vector<char>& bytes = m_staging.bytes;
+    std::size_t offset = bytes.size();
+    bytes.resize(offset + 1 + sizeof(uint32_t) + length);
+    bytes[offset] = static_cast<char>(TEXT);
+    uint32_t size = length;
+    std::memcpy(bytes.data() + offset + 1, &size, sizeof(size));
+    std::memcpy(bytes.data() + offset + 1 + sizeof(size), text, length);
+}
+
+}
@@ -0,0 +1,191 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#ifndef NSIM2023_LOG_ASYNC_H
+#define NSIM2023_LOG_ASYNC_H
+
+#include "log-format.h"
+#include "log.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <stdint.h>
+#include <vector>
+
+
+namespace nsim2023
+{
+
+/**
+ * Send the enabled NS_LOG, NS_LOG_FUNCTION and NS_LOG_FUNCTION_NOARGS
+ * statements to the asynchronous backend.
+ *
+ * The statement then only captures its arguments in binary form, together
+ * with the simulation time and context, into a lock-free ring of the calling
+ * thread; a background thread formats the records and writes them to
+ * std::clog in batches.  The output is the same as the synchronous one,
+ * except that the lines of different threads may interleave differently
+ * and NS_LOG_APPEND_CONTEXT is not supported.
+ *
+ * It can also be selected with the \c async token in the NS_LOG
+ * environment variable, e.g. NS_LOG="Foo=logic|time:async", which takes
+ * effect when the simulator is created.
+ *
+ * \param [in] ringSize The size in bytes of the ring of each thread; rings
+ *             of another size are replaced at the next statement.
+ */
+void LogEnableAsync(std::size_t ringSize = 1 << 20);
+
+/**
+ * Keep the enabled log statements in memory only, as a flight recorder.
+ *
+ * The statements are captured as with LogEnableAsync(), but nothing is
+ * written: once the ring of a thread is full, each record replaces the
+ * oldest ones.  LogAsyncFlush() writes the rings to std::clog, which
+ * NS_FATAL_ERROR, NS_ASSERT and NS_ABORT_* do through
+ * FatalImpl::FlushStreams, so a crash comes with the last events before it.
+ *
+ * It can also be selected with the \c flight token in the NS_LOG
+ * environment variable.
+ *
+ * \param [in] ringSize The size in bytes of the ring of each thread; rings
+ *             of another size are replaced at the next statement.
+ */
+void LogEnableFlightRecorder(std::size_t ringSize = 1 << 20);
+
+/**
+ * Go back to synchronous logging.  The pending records are written, except
+ * those of the flight recorder, which are discarded.
+ */
+void LogDisableAsync();
+
+/**
+ * Write the pending records, or the contents of the flight recorder, now;
+ * called by FatalImpl::FlushStreams.
+ */
+void LogAsyncFlush();
+
+namespace internal
+{
+
+/** True while the asynchronous backend is on. */
+extern std::atomic<bool> g_logAsync;
+
+} // namespace internal
+
+/**
+ * Check whether log statements go to the asynchronous backend.
+ * \returns \c true if LogEnableAsync() or LogEnableFlightRecorder() is in effect.
+ */
+inline bool
+LogIsAsync()
+{
+    return internal::g_logAsync.load(std::memory_order_relaxed);
+}
+
+/**
+ * The record of one log statement for the asynchronous backend.
+ *
+ * Arithmetic values, strings and pointers are stored in binary form and
+ * formatted by the background thread; other values, and everything after a
+ * stream manipulator, are formatted on the spot.  The record is committed
+ * to the ring of the calling thread by the destructor.
+ */
+class LogRecord : public LogArguments<LogRecord>
+{
+  public:
+    /**
+     * Start a record.
+     * \param [in] component The component of the statement.
+     * \param [in] level The level of the statement.
+     * \param [in] function The name of the enclosing function.
+     * \param [in] parameters \c true for NS_LOG_FUNCTION, whose values are
+     *             separated by commas as by ParameterLogger.
+     */
+    LogRecord(const LogComponent& component,
+              const enum LogLevel level,
+              const char* function,
+              bool parameters);
+    /** Commit the record. */
+    ~LogRecord();
+
+    /** Item types of a record. */
+    enum Tag : uint8_t
+    {
+        SIGNED,      //!< int64_t
+        UNSIGNED,    //!< uint64_t
+        FLOATING,    //!< double
+        CHARACTER,   //!< char
+        POINTER,     //!< const void*
+        TEXT,        //!< uint32_t length, then the characters
+    };
+
+  private:
+    friend class LogArguments<LogRecord>;
+
+    /** Append a tag and a trivially copyable value. */
+    template <typename T>
+    void Put(Tag tag, const T& value);
+    /** Append an integer. */
+    void PutSigned(int64_t value)
+    {
+        Put(SIGNED, value);
+    }
+    /** Append an unsigned integer. */
+    void PutUnsigned(uint64_t value)
+    {
+        Put(UNSIGNED, value);
+    }
+    /** Append a floating point value. */
+    void PutFloating(double value)
+    {
+        Put(FLOATING, value);
+    }
+    /** Append a character. */
+    void PutCharacter(char value)
+    {
+        Put(CHARACTER, value);
+    }
+    /** Append a pointer. */
+    void PutPointer(const void* value)
+    {
+        Put(POINTER, value);
+    }
+    /** Append text. */
+    void PutText(const char* text, std::size_t length);
+};
+
+template <typename T>
+void
+LogRecord::Put(Tag tag, const T& value)
+{
+    std::vector<char>& bytes = m_staging.bytes;
+    std::size_t offset = bytes.size();
+    bytes.resize(offset + 1 + sizeof(T));
+    bytes[offset] = static_cast<char>(tag);
+    std::memcpy(bytes.data() + offset + 1, &value, sizeof(T));
+}
+
+}
+
+#endif /* NSIM2023_LOG_ASYNC_H */
@@ -0,0 +1,272 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#include "log-format.h"
+
+#include "nstime.h"
+#include "simulator.h"
+
+#include <charconv>
+#include <cmath>
+#include <memory>
+
+
+namespace nsim2023
+{
+
+namespace
+{
+
+/** Staging buffers of the calling thread; statements may nest. */
+thread_local std::vector<std::unique_ptr<internal::LogStaging>> t_staging;
+
+/** Number of statements under construction on the calling thread. */
+thread_local std::size_t t_depth = 0;
+
+/**
+ * Time steps below this magnitude are formatted from integers: their
+ * double in seconds, as printed by Time::As, rounds to the same digits.
+ */
+constexpr int64_t EXACT_TIME_STEPS = int64_t(1) << 50;
+
+/** Powers of ten, up to the femtosecond. */
+constexpr uint64_t POWERS_OF_TEN[] = {1ULL,
+                                      10ULL,
+                                      100ULL,
+                                      1000ULL,
+                                      10000ULL,
+                                      100000ULL,
+                                      1000000ULL,
+                                      10000000ULL,
+                                      100000000ULL,
+                                      1000000000ULL,
+                                      10000000000ULL,
+                                      100000000000ULL,
+                                      1000000000000ULL,
+                                      10000000000000ULL,
+                                      100000000000000ULL,
+                                      1000000000000000ULL};
+
+/** The last time step formatted by a thread. */
+struct TimeStepCache
+{
+    bool valid{false};       //!< Something has been formatted
+    Time::Unit resolution;   //!< Time resolution of the step
+    int64_t step;            //!< The step
+    int digits;              //!< Digits of the fraction, 0 if formatted from the double
+    bool negative;           //!< The step is negative
+    uint64_t seconds;        //!< Magnitude of the whole seconds
+    uint64_t fraction;       //!< Magnitude of the fraction, in steps
+    std::string text;        //!< The formatted step
+};
+
+/** The last time step formatted by the calling thread. */
+thread_local TimeStepCache t_timeStep;
+
+/**
+ * Digits of the fraction printed by PrintTimeStep for a resolution.
+ * \returns 0 for the resolutions printed with the default precision.
+ */
+int
+FractionDigits(Time::Unit resolution)
+{
+    switch (resolution)
+    {
+    case Time::US:
+        return 6;
+    case Time::NS:
+        return 9;
+    case Time::PS:
+        return 12;
+    case Time::FS:
+        return 15;
+    default:
+        return 0;
+    }
+}
+
+/** Append an unsigned integer padded with zeros to \p digits digits. */
+void
+AppendPadded(std::string& out, uint64_t value, int digits)
+{
+    std::size_t end = out.size() + digits;
+    out.resize(end);
+    for (std::size_t i = end; i-- > end - digits;)
+    {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+} // namespace
+
+namespace internal
+{
+
+LogStaging&
+AcquireLogStaging()
+{
+    if (t_depth == t_staging.size())
+    {
+        t_staging.emplace_back(new LogStaging);
+    }
+    return *t_staging[t_depth++];
+}
+
+void
+ReleaseLogStaging()
+{
+    t_depth--;
+}
+
+} // namespace internal
+
+namespace LogFormat
+{
+
+void
+AppendSigned(std::string& out, int64_t value)
+{
+    char buffer[24];
+    char* end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+    out.append(buffer, end - buffer);
+}
+
+void
+AppendUnsigned(std::string& out, uint64_t value)
+{
+    char buffer[24];
+    char* end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+    out.append(buffer, end - buffer);
+}
+
+void
+AppendDouble(std::string& out, double value)
+{
+    // %g with the default precision of std::ostream
+    char buffer[32];
+    char* end =
+        std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6).ptr;
+    out.append(buffer, end - buffer);
+}
+
+void
+AppendPointer(std::string& out, const void* value)
+{
+    if (value == nullptr)
+    {
+        // std::showbase prints no base for zero
+        out += '0';
+        return;
+    }
+    char buffer[24];
+    char* end =
+        std::to_chars(buffer, buffer + sizeof(buffer), reinterpret_cast<uintptr_t>(value), 16).ptr;
+    out += "0x";
+    out.append(buffer, end - buffer);
+}
+
+void
+AppendTimeStep(std::string& out, int64_t step)
+{
+    TimeStepCache& cache = t_timeStep;
+    Time::Unit resolution = Time::GetResolution();
+    if (cache.valid && cache.step == step && cache.resolution == resolution)
+    {
+        out += cache.text;
+        return;
+    }
+    int digits = FractionDigits(resolution);
+    std::string& text = cache.text;
+    if (digits == 0 || step <= -EXACT_TIME_STEPS || step >= EXACT_TIME_STEPS)
+    {
+        // As PrintTimeStep: the double of Time::As, with std::showpos
+        double value = Time(step).ToDouble(Time::S);
+        char buffer[400];
+        char* end = std::to_chars(buffer,
+                                  buffer + sizeof(buffer),
+                                  value,
+                                  std::chars_format::fixed,
+                                  digits == 0 ? 5 : digits)
+                        .ptr;
+        text.clear();
+        if (!std::signbit(value))
+        {
+            text += '+';
+        }
+        text.append(buffer, end - buffer);
+        text += 's';
+        cache.digits = 0;
+    }
+    else
+    {
+        bool negative = step < 0;
+        uint64_t magnitude = negative ? -static_cast<uint64_t>(step) : step;
+        uint64_t seconds = magnitude / POWERS_OF_TEN[digits];
+        uint64_t fraction = magnitude % POWERS_OF_TEN[digits];
+        if (cache.valid && cache.digits == digits && cache.negative == negative &&
+            cache.seconds == seconds)
+        {
+            // Same second: rewrite the digits of the fraction that changed,
+            // from the last one before the unit
+            std::size_t i = text.size() - 1;
+            uint64_t previous = cache.fraction;
+            for (uint64_t current = fraction; current != previous; current /= 10, previous /= 10)
+            {
+                text[--i] = static_cast<char>('0' + current % 10);
+            }
+        }
+        else
+        {
+            text.clear();
+            text += negative ? '-' : '+';
+            AppendUnsigned(text, seconds);
+            text += '.';
+            AppendPadded(text, fraction, digits);
+            text += 's';
+        }
+        cache.digits = digits;
+        cache.negative = negative;
+        cache.seconds = seconds;
+        cache.fraction = fraction;
+    }
+    cache.valid = true;
+    cache.resolution = resolution;
+    cache.step = step;
+    out += text;
+}
+
+void
+AppendContext(std::string& out, uint32_t context)
+{
+    if (context == Simulator::NO_CONTEXT)
+    {
+        out += "-1";
+    }
+    else
+    {
+        AppendUnsigned(out, context);
+    }
+}
+
+} // namespace LogFormat
+
+}
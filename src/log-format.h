@@ -0,0 +1,360 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#ifndef NSIM2023_LOG_FORMAT_H
+#define NSIM2023_LOG_FORMAT_H
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+namespace nsim2023
+{
+
+/**
+ * Formatting of the log values with std::to_chars into a string, with the
+ * output of a std::ostream in its default format.
+ */
+namespace LogFormat
+{
+
+/** Append \p value, as `os << value`. */
+void AppendSigned(std::string& out, int64_t value);
+
+/** Append \p value, as `os << value`. */
+void AppendUnsigned(std::string& out, uint64_t value);
+
+/** Append \p value, as `os << value`: six significant digits. */
+void AppendDouble(std::string& out, double value);
+
+/** Append \p value, as `os << value`: `0` or the address in hexadecimal. */
+void AppendPointer(std::string& out, const void* value);
+
+/**
+ * Append a time step, as PrintTimeStep() does.
+ *
+ * The last step formatted by the calling thread is kept: the same step is
+ * copied, and a step within the same second only gets the digits of the
+ * fraction that changed rewritten.
+ */
+void AppendTimeStep(std::string& out, int64_t step);
+
+/** Append a simulation context, as DefaultNodePrinter() does. */
+void AppendContext(std::string& out, uint32_t context);
+
+} // namespace LogFormat
+
+namespace internal
+{
+
+/** Buffers of a log statement under construction. */
+struct LogStaging
+{
+    std::vector<char> bytes;    //!< The record of the asynchronous backend
+    std::string text;           //!< The line of the synchronous backend
+    std::ostringstream scratch; //!< Formats the values LogFormat doesn't know
+};
+
+/**
+ * Get the buffers of the calling thread for a new statement; statements
+ * may nest, through the values they print.
+ */
+LogStaging& AcquireLogStaging();
+
+/** Give back the buffers of the innermost statement of the calling thread. */
+void ReleaseLogStaging();
+
+} // namespace internal
+
+/**
+ * The values of a log statement, for LogLine and LogRecord.
+ *
+ * Arithmetic values, strings and pointers are passed to the \c Put*
+ * members of \p Derived; other values, and everything after a stream
+ * manipulator, are formatted by a std::ostringstream and passed as text.
+ * Among the parameters of NS_LOG_FUNCTION the values are separated by
+ * commas and the strings quoted, as by ParameterLogger.
+ *
+ * \tparam Derived The backend, with PutSigned(int64_t), PutUnsigned(uint64_t),
+ *         PutFloating(double), PutCharacter(char), PutPointer(const void*)
+ *         and PutText(const char*, std::size_t).
+ */
+template <typename Derived>
+class LogArguments
+{
+  public:
+    // Delete copy constructor and assignment operator to avoid misuse
+    LogArguments(const LogArguments&) = delete;
+    LogArguments& operator=(const LogArguments&) = delete;
+
+    /**
+     * Append a value.
+     * \param [in] value The value.
+     * \returns This statement.
+     */
+    template <typename T>
+    Derived& operator<<(const T& value);
+    /** \copydoc operator<<(const T&) */
+    Derived& operator<<(const char* value);
+    /** \copydoc operator<<(const T&) */
+    Derived& operator<<(const std::string& value);
+    /** \copydoc operator<<(const T&) */
+    template <typename T>
+    Derived& operator<<(const std::vector<T>& value);
+    /** \copydoc operator<<(const T&) */
+    Derived& operator<<(std::ostream& (*value)(std::ostream&));
+
+  protected:
+    /** Take the buffers of the calling thread. */
+    LogArguments()
+        : m_staging(internal::AcquireLogStaging())
+    {
+    }
+
+    /** Give the buffers back, with the scratch stream empty and in the default format. */
+    ~LogArguments()
+    {
+        if (m_formatted)
+        {
+            ResetFormat(m_staging.scratch);
+        }
+        internal::ReleaseLogStaging();
+    }
+
+    /** Reset the format of a stream to the one of a new stream. */
+    static void ResetFormat(std::ostream& os)
+    {
+        os.flags(std::ios_base::skipws | std::ios_base::dec);
+        os.precision(6);
+        os.width(0);
+        os.fill(' ');
+    }
+
+    /** The stream formatting the values that are not passed in binary form. */
+    std::ostream& Scratch()
+    {
+        return m_staging.scratch;
+    }
+
+    /** Pass what has been formatted into the scratch stream as text. */
+    void PutScratch()
+    {
+        std::ostringstream& scratch = m_staging.scratch;
+        const std::string& text = scratch.str();
+        Self().PutText(text.data(), text.size());
+        scratch.str("");
+    }
+
+    internal::LogStaging& m_staging; //!< Buffers of the calling thread
+    bool m_parameters{false};        //!< NS_LOG_FUNCTION parameters
+
+  private:
+    /** \returns The backend. */
+    Derived& Self()
+    {
+        return static_cast<Derived&>(*this);
+    }
+
+    /** Add `, ` before every parameter after the first. */
+    void CommaRest();
+    /** Append a string, quoted among parameters. */
+    void PutString(const char* value, std::size_t length);
+    /** Append an arithmetic value. */
+    template <typename T>
+    void PutArithmetic(T value);
+
+    bool m_first{true};      //!< First parameter, doesn't get `, `
+    bool m_formatted{false}; //!< The scratch stream may have a non-default format
+};
+
+template <typename Derived>
+void
+LogArguments<Derived>::CommaRest()
+{
+    if (!m_parameters)
+    {
+        return;
+    }
+    if (m_first)
+    {
+        m_first = false;
+    }
+    else
+    {
+        Self().PutText(", ", 2);
+    }
+}
+
+template <typename Derived>
+void
+LogArguments<Derived>::PutString(const char* value, std::size_t length)
+{
+    CommaRest();
+    if (m_parameters)
+    {
+        // As ParameterLogger: strings are quoted
+        Self().PutText("\"", 1);
+        Self().PutText(value, length);
+        Self().PutText("\"", 1);
+    }
+    else
+    {
+        Self().PutText(value, length);
+    }
+}
+
+template <typename Derived>
+template <typename T>
+void
+LogArguments<Derived>::PutArithmetic(T value)
+{
+    if (m_formatted)
+    {
+        Scratch() << value;
+        PutScratch();
+    }
+    else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+                       std::is_same_v<T, unsigned char>)
+    {
+        Self().PutCharacter(static_cast<char>(value));
+    }
+    else if constexpr (std::is_same_v<T, bool>)
+    {
+        Self().PutSigned(static_cast<int64_t>(value));
+    }
+    else if constexpr (std::is_floating_point_v<T> && sizeof(T) <= sizeof(double))
+    {
+        Self().PutFloating(static_cast<double>(value));
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        Scratch() << value;
+        PutScratch();
+    }
+    else if constexpr (std::is_signed_v<T>)
+    {
+        Self().PutSigned(static_cast<int64_t>(value));
+    }
+    else
+    {
+        Self().PutUnsigned(static_cast<uint64_t>(value));
+    }
+}
+
+template <typename Derived>
+template <typename T>
+Derived&
+LogArguments<Derived>::operator<<(const T& value)
+{
+    if constexpr (std::is_pointer_v<T> &&
+                  std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>)
+    {
+        return *this << static_cast<const char*>(value);
+    }
+    CommaRest();
+    if constexpr (std::is_arithmetic_v<T>)
+    {
+        if (m_parameters && (std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t>))
+        {
+            // As ParameterLogger: small integers are numbers, not characters
+            PutArithmetic(static_cast<int16_t>(value));
+        }
+        else
+        {
+            PutArithmetic(value);
+        }
+    }
+    else if constexpr (std::is_pointer_v<T> && !std::is_function_v<std::remove_pointer_t<T>>)
+    {
+        if (m_formatted)
+        {
+            Scratch() << value;
+            PutScratch();
+        }
+        else
+        {
+            Self().PutPointer(static_cast<const void*>(value));
+        }
+    }
+    else
+    {
+        // Manipulators such as std::setw also land here, and from then on
+        // the scratch stream formats the arithmetic values too.
+        m_formatted = true;
+        Scratch() << value;
+        PutScratch();
+    }
+    return Self();
+}
+
+template <typename Derived>
+Derived&
+LogArguments<Derived>::operator<<(const char* value)
+{
+    if (value == nullptr)
+    {
+        // Where std::ostream would set its badbit
+        value = "(null)";
+    }
+    PutString(value, std::strlen(value));
+    return Self();
+}
+
+template <typename Derived>
+Derived&
+LogArguments<Derived>::operator<<(const std::string& value)
+{
+    PutString(value.data(), value.size());
+    return Self();
+}
+
+template <typename Derived>
+template <typename T>
+Derived&
+LogArguments<Derived>::operator<<(const std::vector<T>& value)
+{
+    for (const auto& i : value)
+    {
+        *this << i;
+    }
+    return Self();
+}
+
+template <typename Derived>
+Derived&
+LogArguments<Derived>::operator<<(std::ostream& (*value)(std::ostream&))
+{
+    CommaRest();
+    m_formatted = true;
+    Scratch() << value;
+    PutScratch();
+    return Self();
+}
+
+}
+
+#endif /* NSIM2023_LOG_FORMAT_H */
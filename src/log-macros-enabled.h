@@ -83,19 +83,35 @@
     #define NS_LOG_CONDITION
 #endif
 
+#define NS_LOG_STRINGIFY_IMPL(...) #__VA_ARGS__
+#define NS_LOG_STRINGIFY(...) NS_LOG_STRINGIFY_IMPL(__VA_ARGS__)
+
+// Write the time and node prefixes of a LogLine before a user defined
+// NS_LOG_APPEND_CONTEXT, which writes to std::clog; nothing otherwise.
+#define NS_LOG_APPEND_LINE_CONTEXT(line)                                                           \
+    if (sizeof(NS_LOG_STRINGIFY(NS_LOG_APPEND_CONTEXT)) > 1)                                       \
+    {                                                                                              \
+        line.Flush();                                                                              \
+        NS_LOG_APPEND_CONTEXT;                                                                     \
+    }
+
 
 #define NS_LOG(level, msg)                                                                         \
     NS_LOG_CONDITION                                                                               \
     do                                                                                             \
     {                                                                                              \
-        if (g_log.IsEnabled(level))                                                                \
+        if (nsim2023::LogLevelCompiled(level) && g_log.IsEnabled(level) && g_log.Admit(level))     \
         {                                                                                          \
-            NS_LOG_APPEND_TIME_PREFIX;                                                             \
-            NS_LOG_APPEND_NODE_PREFIX;                                                             \
-            NS_LOG_APPEND_CONTEXT;                                                                 \
-            NS_LOG_APPEND_FUNC_PREFIX;                                                             \
-            NS_LOG_APPEND_LEVEL_PREFIX(level);                                                     \
-            std::clog << msg << std::endl;                                                         \
+            if (nsim2023::LogIsAsync())                                                            \
+            {                                                                                      \
+                nsim2023::LogRecord(g_log, level, __FUNCTION__, false) << msg;                     \
+            }                                                                                      \
+            else                                                                                   \
+            {                                                                                      \
+                nsim2023::LogLine nsim2023LogLine(g_log);                                          \
+                NS_LOG_APPEND_LINE_CONTEXT(nsim2023LogLine);                                       \
+                nsim2023LogLine.Start(level, __FUNCTION__, false) << msg;                          \
+            }                                                                                      \
         }                                                                                          \
     } while (false)
 
@@ -105,12 +121,19 @@
     NS_LOG_CONDITION                                                                               \
     do                                                                                             \
     {                                                                                              \
-        if (g_log.IsEnabled(nsim2023::LOG_FUNCTION))                                                    \
+        if (nsim2023::LogLevelCompiled(nsim2023::LOG_FUNCTION) &&                                  \
+            g_log.IsEnabled(nsim2023::LOG_FUNCTION) && g_log.Admit(nsim2023::LOG_FUNCTION))        \
         {                                                                                          \
-            NS_LOG_APPEND_TIME_PREFIX;                                                             \
-            NS_LOG_APPEND_NODE_PREFIX;                                                             \
-            NS_LOG_APPEND_CONTEXT;                                                                 \
-            std::clog << g_log.Name() << ":" << __FUNCTION__ << "()" << std::endl;                 \
+            if (nsim2023::LogIsAsync())                                                            \
+            {                                                                                      \
+                nsim2023::LogRecord(g_log, nsim2023::LOG_FUNCTION, __FUNCTION__, true);            \
+            }                                                                                      \
+            else                                                                                   \
+            {                                                                                      \
+                nsim2023::LogLine nsim2023LogLine(g_log);                                          \
+                NS_LOG_APPEND_LINE_CONTEXT(nsim2023LogLine);                                       \
+                nsim2023LogLine.Start(nsim2023::LOG_FUNCTION, __FUNCTION__, true);                 \
+            }                                                                                      \
         }                                                                                          \
     } while (false)
 
@@ -120,14 +143,20 @@
     NS_LOG_CONDITION                                                                               \
     do                                                                                             \
     {                                                                                              \
-        if (g_log.IsEnabled(nsim2023::LOG_FUNCTION))                                                    \
+        if (nsim2023::LogLevelCompiled(nsim2023::LOG_FUNCTION) &&                                  \
+            g_log.IsEnabled(nsim2023::LOG_FUNCTION) && g_log.Admit(nsim2023::LOG_FUNCTION))        \
         {                                                                                          \
-            NS_LOG_APPEND_TIME_PREFIX;                                                             \
-            NS_LOG_APPEND_NODE_PREFIX;                                                             \
-            NS_LOG_APPEND_CONTEXT;                                                                 \
-            std::clog << g_log.Name() << ":" << __FUNCTION__ << "(";                               \
-            nsim2023::ParameterLogger(std::clog) << parameters;                                         \
-            std::clog << ")" << std::endl;                                                         \
+            if (nsim2023::LogIsAsync())                                                            \
+            {                                                                                      \
+                nsim2023::LogRecord(g_log, nsim2023::LOG_FUNCTION, __FUNCTION__, true)             \
+                    << parameters;                                                                 \
+            }                                                                                      \
+            else                                                                                   \
+            {                                                                                      \
+                nsim2023::LogLine nsim2023LogLine(g_log);                                          \
+                NS_LOG_APPEND_LINE_CONTEXT(nsim2023LogLine);                                       \
+                nsim2023LogLine.Start(nsim2023::LOG_FUNCTION, __FUNCTION__, true) << parameters;   \
+            }                                                                                      \
         }                                                                                          \
     } while (false)
 
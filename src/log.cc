@@ -25,7 +25,9 @@
 #include "fatal-error.h"
 
 #include "core-config.h"
+#include "simulator.h"
 
+#include <cmath>
 #include <cstdlib> // getenv
 #include <cstring> // strlen
 #include <iostream>
@@ -54,6 +56,16 @@ class PrintList
 
 static PrintList g_printList;
 
+// Check for a `name=N` option with a valid count N.
+static bool ValidCount(const std::string& lev, const std::string& name)
+{
+    if (lev.compare(0, name.size(), name) != 0 || lev.size() == name.size())
+    {
+        return false;
+    }
+    return lev.find_first_not_of("0123456789", name.size()) == std::string::npos;
+}
+
 /* static */
 LogComponent::ComponentList*
 LogComponent::GetComponentList()
@@ -247,6 +259,14 @@ void LogComponent::EnvVarCheck()
                     {
                         level |= LOG_LEVEL_ALL | LOG_PREFIX_ALL;
                     }
+                    else if (ValidCount(lev, "sample="))
+                    {
+                        SetSampling(std::stoul(lev.substr(7)));
+                    }
+                    else if (ValidCount(lev, "rate="))
+                    {
+                        SetRateLimit(std::stoul(lev.substr(5)));
+                    }
 
                     pre_pipe = false;
                 } while (next_lev != std::string::npos);
@@ -258,23 +278,62 @@ void LogComponent::EnvVarCheck()
     }
 }
 
-bool
-LogComponent::IsEnabled(const enum LogLevel level) const
+void
+LogComponent::SetMask(const enum LogLevel level)
 {
-    //  LogComponentEnableEnvVar ();
-    return (level & m_levels) ? 1 : 0;
+    m_mask |= level;
 }
 
-bool
-LogComponent::IsNoneEnabled() const
+void
+LogComponent::SetSampling(uint32_t oneIn)
+{
+    m_sampling = oneIn;
+    m_limited = m_sampling > 1 || m_rateLimit > 0;
+}
+
+uint32_t
+LogComponent::GetSampling() const
 {
-    return m_levels == 0;
+    return m_sampling;
 }
 
 void
-LogComponent::SetMask(const enum LogLevel level)
+LogComponent::SetRateLimit(uint32_t perSecond)
 {
-    m_mask |= level;
+    m_rateLimit = perSecond;
+    m_limited = m_sampling > 1 || m_rateLimit > 0;
+}
+
+uint32_t
+LogComponent::GetRateLimit() const
+{
+    return m_rateLimit;
+}
+
+bool
+LogComponent::DoAdmit()
+{
+    if (m_sampling > 1 && m_sampleCount.fetch_add(1, std::memory_order_relaxed) % m_sampling != 0)
+    {
+        return false;
+    }
+    if (m_rateLimit > 0)
+    {
+        // Before the simulator exists (no time printer yet) it is all second 0
+        int64_t second = 0;
+        if (g_logTimePrinter != nullptr)
+        {
+            second = static_cast<int64_t>(std::floor(Simulator::Now().GetSeconds()));
+        }
+        int64_t current = m_rateSecond.load(std::memory_order_relaxed);
+        if (second != current &&
+            m_rateSecond.compare_exchange_strong(current, second, std::memory_order_relaxed))
+        {
+            m_rateCount.store(0, std::memory_order_relaxed);
+        }
+        return m_rateCount.fetch_add(1, std::memory_order_relaxed) < m_rateLimit;
+    }
+    return true;
 }
 
 void
@@ -466,6 +525,14 @@ void LogComponentPrintList()
                 std::cout << "|level";
             }
         }
+        if (i->second->GetSampling() > 1)
+        {
+            std::cout << "|sample=" << i->second->GetSampling();
+        }
+        if (i->second->GetRateLimit() > 0)
+        {
+            std::cout << "|rate=" << i->second->GetRateLimit();
+        }
         std::cout << std::endl;
     }
 }
@@ -512,7 +579,11 @@ static void CheckEnvironmentVariables()
         {
             // ie no '=' characters found
             component = tmp;
-            if (ComponentExists(component) || component == "*" || component == "***")
+            if (component == "async" || component == "flight")
+            {
+                // Not a component, see LogEnableAsync and LogEnableFlightRecorder
+            }
+            else if (ComponentExists(component) || component == "*" || component == "***")
             {
                 return;
             }
@@ -544,7 +615,8 @@ static void CheckEnvironmentVariables()
                         lev == "prefix_level" || lev == "level" || lev == "prefix_all" ||
                         lev == "level_error" || lev == "level_warn" || lev == "level_debug" ||
                         lev == "level_info" || lev == "level_function" || lev == "level_logic" ||
-                        lev == "level_all" || lev == "*" || lev == "**")
+                        lev == "level_all" || lev == "*" || lev == "**" ||
+                        ValidCount(lev, "sample=") || ValidCount(lev, "rate="))
                     {
                         continue;
                     }
@@ -569,6 +641,29 @@ static void CheckEnvironmentVariables()
     }
 }
 
+// Check for a token such as async in NS_LOG.
+static bool EnvHasToken(const std::string& token)
+{
+    const char* envVar = std::getenv("NS_LOG");
+    if (envVar == nullptr)
+    {
+        return false;
+    }
+    std::string env = envVar;
+    std::string::size_type cur = 0;
+    std::string::size_type next = 0;
+    while (next != std::string::npos)
+    {
+        next = env.find_first_of(':', cur);
+        if (env.compare(cur, next - cur, token) == 0)
+        {
+            return true;
+        }
+        cur = next + 1;
+    }
+    return false;
+}
+
 void LogSetTimePrinter(TimePrinter printer)
 {
     g_logTimePrinter = printer;
@@ -577,6 +672,17 @@ void LogSetTimePrinter(TimePrinter printer)
      * are registered. See \bugid{1082} for details.
      */
     CheckEnvironmentVariables();
+    if (printer != nullptr && !LogIsAsync())
+    {
+        if (EnvHasToken("flight"))
+        {
+            LogEnableFlightRecorder();
+        }
+        else if (EnvHasToken("async"))
+        {
+            LogEnableAsync();
+        }
+    }
 }
 
 TimePrinter LogGetTimePrinter()
@@ -594,6 +700,88 @@ NodePrinter LogGetNodePrinter()
     return g_logNodePrinter;
 }
 
+LogLine::LogLine(const LogComponent& component)
+    : m_component(component)
+{
+    std::string& text = m_staging.text;
+    text.clear();
+    TimePrinter timePrinter = component.IsEnabled(LOG_PREFIX_TIME) ? g_logTimePrinter : nullptr;
+    if (timePrinter == &DefaultTimePrinter)
+    {
+        LogFormat::AppendTimeStep(text, Simulator::Now().GetTimeStep());
+        text += ' ';
+    }
+    else if (timePrinter != nullptr)
+    {
+        (*timePrinter)(Scratch());
+        Scratch() << " ";
+        PutScratch();
+        ResetFormat(Scratch());
+    }
+    NodePrinter nodePrinter = component.IsEnabled(LOG_PREFIX_NODE) ? g_logNodePrinter : nullptr;
+    if (nodePrinter == &DefaultNodePrinter)
+    {
+        LogFormat::AppendContext(text, Simulator::GetContext());
+        text += ' ';
+    }
+    else if (nodePrinter != nullptr)
+    {
+        (*nodePrinter)(Scratch());
+        Scratch() << " ";
+        PutScratch();
+        ResetFormat(Scratch());
+    }
+}
+
+LogLine::~LogLine()
+{
+    std::string& text = m_staging.text;
+    if (m_parameters)
+    {
+        text += ')';
+    }
+    text += '\n';
+    std::clog.write(text.data(), text.size());
+    std::clog.flush();
+}
+
+void
+LogLine::Flush()
+{
+    std::string& text = m_staging.text;
+    std::clog.write(text.data(), text.size());
+    text.clear();
+}
+
+LogLine&
+LogLine::Start(const enum LogLevel level, const char* function, bool parameters)
+{
+    std::string& text = m_staging.text;
+    m_parameters = parameters;
+    if (parameters)
+    {
+        text += m_component.Name();
+        text += ':';
+        text += function;
+        text += '(';
+        return *this;
+    }
+    if (m_component.IsEnabled(LOG_PREFIX_FUNC))
+    {
+        text += m_component.Name();
+        text += ':';
+        text += function;
+        text += "(): ";
+    }
+    if (m_component.IsEnabled(LOG_PREFIX_LEVEL))
+    {
+        text += '[';
+        text += LogComponent::GetLevelLabel(level);
+        text += "] ";
+    }
+    return *this;
+}
+
 ParameterLogger::ParameterLogger(std::ostream& os)
     : m_os(os)
 {
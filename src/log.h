@@ -22,11 +22,13 @@
 #ifndef NSIM2023_LOG_H
 #define NSIM2023_LOG_H
 
+#include "log-format.h"
 #include "log-macros-disabled.h"
 #include "log-macros-enabled.h"
 #include "node-printer.h"
 #include "time-printer.h"
 
+#include <atomic>
 #include <iostream>
 #include <map>
 #include <stdint.h>
@@ -74,6 +76,29 @@ enum LogLevel
     LOG_PREFIX_ALL = 0xf0000000    //!< All prefixes.
 };
 
+/**
+ * In builds with NSIM2023_LOG_MIN_LEVEL, e.g. -DNSIM2023_LOG_MIN_LEVEL=LOG_WARN,
+ * the statements of less severe levels compile to nothing, whatever the
+ * components enable at run time; the other levels stay live.
+ */
+#ifndef NSIM2023_LOG_MIN_LEVEL
+#define NSIM2023_LOG_MIN_LEVEL LOG_ALL
+#endif
+
+/** The least severe level compiled in. */
+constexpr uint32_t LOG_MIN_LEVEL = NSIM2023_LOG_MIN_LEVEL;
+
+/**
+ * Check whether the statements of a level are compiled in.
+ * \param [in] level The level of the statement.
+ * \returns \c true if \p level is at least as severe as LOG_MIN_LEVEL.
+ */
+constexpr bool
+LogLevelCompiled(const enum LogLevel level)
+{
+    return static_cast<uint32_t>(level) <= LOG_MIN_LEVEL;
+}
+
 
 // Enable the logging output associated with that log component
 void LogComponentEnable(const char* name, enum LogLevel level);
@@ -154,9 +179,13 @@ class LogComponent
                  const std::string& file,
                  const enum LogLevel mask = LOG_NONE);
  
-    bool IsEnabled(const enum LogLevel level) const;
+    /**
+     * Check whether a level is enabled.  Inline, as it guards every log
+     * statement, and predicted false.
+     */
+    inline bool IsEnabled(const enum LogLevel level) const;
 
-    bool IsNoneEnabled() const;
+    inline bool IsNoneEnabled() const;
 
     void Enable(const enum LogLevel level);
 
@@ -170,6 +199,31 @@ class LogComponent
 
     void SetMask(const enum LogLevel level);
 
+    /**
+     * Print only one in \p oneIn of the statements below LOG_WARN;
+     * 0 or 1 prints them all.  Also set by `sample=N` in NS_LOG.
+     */
+    void SetSampling(uint32_t oneIn);
+
+    /** \returns The sampling set by SetSampling(). */
+    uint32_t GetSampling() const;
+
+    /**
+     * Print at most \p perSecond statements below LOG_WARN per simulated
+     * second; 0 removes the limit.  Also set by `rate=K` in NS_LOG.
+     */
+    void SetRateLimit(uint32_t perSecond);
+
+    /** \returns The limit set by SetRateLimit(). */
+    uint32_t GetRateLimit() const;
+
+    /**
+     * Apply the sampling and the rate limit to an enabled statement.
+     * \param [in] level The level of the statement.
+     * \returns \c true if the statement is to be printed.
+     */
+    inline bool Admit(const enum LogLevel level);
+
     typedef std::map<std::string, LogComponent*> ComponentList;
 
     static ComponentList* GetComponentList();
@@ -181,13 +235,40 @@ class LogComponent
      */
     void EnvVarCheck();
 
+    /** Admit() when sampling or rate limiting. */
+    bool DoAdmit();
+
     int32_t m_levels;   //!< Enabled LogLevels.
     int32_t m_mask;     //!< Blocked LogLevels.
     std::string m_name; //!< LogComponent name.
     std::string m_file; //!< File defining this LogComponent.
 
+    bool m_limited{false};                 //!< Sampling or rate limiting is on.
+    uint32_t m_sampling{0};                //!< Print one in this many statements.
+    uint32_t m_rateLimit{0};               //!< Statements per simulated second.
+    std::atomic<uint32_t> m_sampleCount{0}; //!< Statements seen by the sampling.
+    std::atomic<int64_t> m_rateSecond{-1};  //!< Simulated second of m_rateCount.
+    std::atomic<uint32_t> m_rateCount{0};   //!< Statements admitted in m_rateSecond.
+
 }; // class LogComponent
 
+bool
+LogComponent::IsEnabled(const enum LogLevel level) const
+{
+    return __builtin_expect((level & m_levels) != 0, 0);
+}
+
+bool
+LogComponent::IsNoneEnabled() const
+{
+    return m_levels == 0;
+}
+
+bool
+LogComponent::Admit(const enum LogLevel level)
+{
+    return __builtin_expect(!m_limited, 1) || (level & LOG_LEVEL_WARN) || DoAdmit();
+}
 
 
 LogComponent& GetLogComponent(const std::string name);
@@ -263,6 +344,100 @@ ParameterLogger& ParameterLogger::operator<< <int8_t>(const int8_t param);
 template <>
 ParameterLogger& ParameterLogger::operator<< <uint8_t>(const uint8_t param);
 
+/**
+ * One line of the synchronous NS_LOG, NS_LOG_FUNCTION and
+ * NS_LOG_FUNCTION_NOARGS statements.
+ *
+ * The line is formatted by LogFormat into a buffer of the calling thread,
+ * as std::clog in its default format would print it, and written to
+ * std::clog at once by the destructor.
+ */
+class LogLine : public LogArguments<LogLine>
+{
+  public:
+    /**
+     * Start a line with the time and node prefixes enabled for a component.
+     * \param [in] component The component of the statement.
+     */
+    LogLine(const LogComponent& component);
+    /** Write the line. */
+    ~LogLine();
+
+    /**
+     * Write what the line holds so far, for NS_LOG_APPEND_CONTEXT to
+     * write to std::clog after it.
+     */
+    void Flush();
+
+    /**
+     * Add the function and level prefixes of NS_LOG, or the function name
+     * of NS_LOG_FUNCTION, whose values are separated by commas as by
+     * ParameterLogger.
+     * \param [in] level The level of the statement.
+     * \param [in] function The name of the enclosing function.
+     * \param [in] parameters \c true for NS_LOG_FUNCTION.
+     * \returns This line.
+     */
+    LogLine& Start(const enum LogLevel level, const char* function, bool parameters);
+
+  private:
+    friend class LogArguments<LogLine>;
+
+    /** Append an integer. */
+    inline void PutSigned(int64_t value);
+    /** Append an unsigned integer. */
+    inline void PutUnsigned(uint64_t value);
+    /** Append a floating point value. */
+    inline void PutFloating(double value);
+    /** Append a character. */
+    inline void PutCharacter(char value);
+    /** Append a pointer. */
+    inline void PutPointer(const void* value);
+    /** Append text. */
+    inline void PutText(const char* text, std::size_t length);
+
+    const LogComponent& m_component; //!< Component of the statement
+};
+
+void
+LogLine::PutSigned(int64_t value)
+{
+    LogFormat::AppendSigned(m_staging.text, value);
+}
+
+void
+LogLine::PutUnsigned(uint64_t value)
+{
+    LogFormat::AppendUnsigned(m_staging.text, value);
+}
+
+void
+LogLine::PutFloating(double value)
+{
+    LogFormat::AppendDouble(m_staging.text, value);
 }
 
+void
+LogLine::PutCharacter(char value)
+{
+    m_staging.text += value;
+}
+
+void
+LogLine::PutPointer(const void* value)
+{
+    LogFormat::AppendPointer(m_staging.text, value);
+}
+
+void
+LogLine::PutText(const char* text, std::size_t length)
+{
+    m_staging.text.append(text, length);
+}
+
+}
+
+// The asynchronous backend needs LogComponent
+#include "log-async.h"
+
 #endif
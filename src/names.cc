@@ -35,6 +35,9 @@ namespace nsim2023
 
 NS_LOG_COMPONENT_DEFINE("Names");
 
+/** Incremented by every change to the name space. */
+static uint64_t g_namesGeneration = 0;
+
 
 class NameNode
 {
@@ -735,6 +738,7 @@ Names::Add(std::string name, Ptr<Object> object)
     NS_LOG_FUNCTION(name << object);
     bool result = NamesPriv::Get()->Add(name, object);
     NS_ABORT_MSG_UNLESS(result, "Names::Add(): Error adding name " << name);
+    g_namesGeneration++;
 }
 
 void
@@ -743,6 +747,7 @@ Names::Rename(std::string oldpath, std::string newname)
     NS_LOG_FUNCTION(oldpath << newname);
     bool result = NamesPriv::Get()->Rename(oldpath, newname);
     NS_ABORT_MSG_UNLESS(result, "Names::Rename(): Error renaming " << oldpath << " to " << newname);
+    g_namesGeneration++;
 }
 
 void
@@ -751,6 +756,7 @@ Names::Add(std::string path, std::string name, Ptr<Object> object)
     NS_LOG_FUNCTION(path << name << object);
     bool result = NamesPriv::Get()->Add(path, name, object);
     NS_ABORT_MSG_UNLESS(result, "Names::Add(): Error adding " << path << " " << name);
+    g_namesGeneration++;
 }
 
 void
@@ -761,6 +767,7 @@ Names::Rename(std::string path, std::string oldname, std::string newname)
     NS_ABORT_MSG_UNLESS(result,
                         "Names::Rename (): Error renaming " << path << " " << oldname << " to "
                                                             << newname);
+    g_namesGeneration++;
 }
 
 void
@@ -771,6 +778,7 @@ Names::Add(Ptr<Object> context, std::string name, Ptr<Object> object)
     NS_ABORT_MSG_UNLESS(result,
                         "Names::Add(): Error adding name " << name << " under context "
                                                            << &context);
+    g_namesGeneration++;
 }
 
 void
@@ -781,6 +789,7 @@ Names::Rename(Ptr<Object> context, std::string oldname, std::string newname)
     NS_ABORT_MSG_UNLESS(result,
                         "Names::Rename (): Error renaming " << oldname << " to " << newname
                                                             << " under context " << &context);
+    g_namesGeneration++;
 }
 
 std::string
@@ -801,9 +810,16 @@ void
 Names::Clear()
 {
     NS_LOG_FUNCTION_NOARGS();
+    g_namesGeneration++;
     return NamesPriv::Get()->Clear();
 }
 
+uint64_t
+Names::GetGeneration()
+{
+    return g_namesGeneration;
+}
+
 Ptr<Object>
 Names::FindInternal(std::string name)
 {
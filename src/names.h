@@ -127,6 +127,12 @@ class Names
 
     static void Clear();
 
+    /**
+     * Get the number of changes made to the name space so far: every
+     * Add, Rename and Clear counts one.
+     */
+    static uint64_t GetGeneration();
+
 
     template <typename T>
     static Ptr<T> Find(std::string path);
@@ -30,17 +30,76 @@
 #include "type-name.h"
 
 #include <cmath>
+#include <cstddef>
 #include <limits>
 #include <ostream>
 #include <set>
 #include <stdint.h>
 
 
+/**
+ * In builds with NSIM2023_TIME_FIXED_RESOLUTION the Time resolution is
+ * NSIM2023_TIME_FIXED_UNIT (a Time::Unit, nanoseconds by default), and the
+ * conversions between Time and the other units are constexpr integer or
+ * floating point operations by compile-time constants.
+ */
+#ifdef NSIM2023_TIME_FIXED_RESOLUTION
+#ifndef NSIM2023_TIME_FIXED_UNIT
+#define NSIM2023_TIME_FIXED_UNIT NS
+#endif
+#define NSIM2023_TIME_CONSTEXPR constexpr
+#else
+#define NSIM2023_TIME_CONSTEXPR
+#endif
+
 namespace nsim2023
 {
 
 class TimeWithUnit;
 
+#ifdef NSIM2023_TIME_FIXED_RESOLUTION
+namespace internal
+{
+
+/** Conversion between a unit and the fixed Time resolution. */
+struct TimeFactor
+{
+    bool isValid;   //!< True if the factor fits in an int64_t
+    bool fromMul;   //!< Multiply when converting From, otherwise divide
+    int64_t factor; //!< Ratio of the coarser over the finer unit
+    double inverse; //!< 1 / factor
+};
+
+/**
+ * Compute the conversion between \p unit and \p resolution, both given
+ * as Time::Unit values.
+ */
+constexpr TimeFactor
+MakeTimeFactor(int unit, int resolution)
+{
+    //                    Y,   D,  H, MIN,  S, MS, US, NS, PS, FS
+    constexpr int power[] = {17, 17, 17, 16, 15, 12, 9, 6, 3, 0};
+    constexpr int64_t coeff[] = {315360, 864, 36, 6, 1, 1, 1, 1, 1, 1};
+
+    int shift = power[unit] - power[resolution];
+    bool fromMul = shift > 0 || (shift == 0 && coeff[unit] >= coeff[resolution]);
+    int64_t quotient = fromMul ? coeff[unit] / coeff[resolution] : coeff[resolution] / coeff[unit];
+    double factor = static_cast<double>(quotient);
+    for (int i = 0; i < (shift < 0 ? -shift : shift); i++)
+    {
+        factor *= 10;
+    }
+    if (factor > 9.2e18)
+    {
+        return TimeFactor{false, fromMul, 1, 1.0};
+    }
+    int64_t f = static_cast<int64_t>(factor);
+    return TimeFactor{true, fromMul, f, 1.0 / f};
+}
+
+}
+#endif
+
 
 // Management of virtual time in real world units.
 class Time
@@ -65,14 +124,33 @@ class Time
         AUTO = 11               //!< auto-scale output when using Time::As()
     };
 
-    inline Time& operator=(const Time& o)
+#ifdef NSIM2023_TIME_FIXED_RESOLUTION
+    /** The resolution of this build. */
+    static constexpr enum Unit FIXED_UNIT = NSIM2023_TIME_FIXED_UNIT;
+
+    /** Conversion factors from each unit to FIXED_UNIT. */
+    static constexpr internal::TimeFactor FIXED_FACTOR[LAST] = {
+        internal::MakeTimeFactor(Y, FIXED_UNIT),
+        internal::MakeTimeFactor(D, FIXED_UNIT),
+        internal::MakeTimeFactor(H, FIXED_UNIT),
+        internal::MakeTimeFactor(MIN, FIXED_UNIT),
+        internal::MakeTimeFactor(S, FIXED_UNIT),
+        internal::MakeTimeFactor(MS, FIXED_UNIT),
+        internal::MakeTimeFactor(US, FIXED_UNIT),
+        internal::MakeTimeFactor(NS, FIXED_UNIT),
+        internal::MakeTimeFactor(PS, FIXED_UNIT),
+        internal::MakeTimeFactor(FS, FIXED_UNIT),
+    };
+#endif
+
+    inline NSIM2023_TIME_CONSTEXPR Time& operator=(const Time& o)
     {
         m_data = o.m_data;
         return *this;
     }
 
 
-    inline Time()  : m_data()
+    inline NSIM2023_TIME_CONSTEXPR Time()  : m_data()
     {
         if (g_markingTimes)
         {
@@ -80,7 +158,7 @@ class Time
         }
     }
 
-    inline Time(const Time& o)  : m_data(o.m_data)
+    inline NSIM2023_TIME_CONSTEXPR Time(const Time& o)  : m_data(o.m_data)
     {
         if (g_markingTimes)
         {
@@ -88,7 +166,7 @@ class Time
         }
     }
 
-    Time(Time&& o)
+    NSIM2023_TIME_CONSTEXPR Time(Time&& o)
         : m_data(o.m_data)
     {
         if (g_markingTimes)
@@ -106,7 +184,7 @@ class Time
         }
     }
 
-    explicit inline Time(int v)
+    explicit inline NSIM2023_TIME_CONSTEXPR Time(int v)
         : m_data(v)
     {
         if (g_markingTimes)
@@ -115,7 +193,7 @@ class Time
         }
     }
 
-    explicit inline Time(long int v)
+    explicit inline NSIM2023_TIME_CONSTEXPR Time(long int v)
         : m_data(v)
     {
         if (g_markingTimes)
@@ -124,7 +202,7 @@ class Time
         }
     }
 
-    explicit inline Time(long long int v)
+    explicit inline NSIM2023_TIME_CONSTEXPR Time(long long int v)
         : m_data(v)
     {
         if (g_markingTimes)
@@ -133,7 +211,7 @@ class Time
         }
     }
 
-    explicit inline Time(unsigned int v)
+    explicit inline NSIM2023_TIME_CONSTEXPR Time(unsigned int v)
         : m_data(v)
     {
         if (g_markingTimes)
@@ -142,7 +220,7 @@ class Time
         }
     }
 
-    explicit inline Time(unsigned long int v)
+    explicit inline NSIM2023_TIME_CONSTEXPR Time(unsigned long int v)
         : m_data(v)
     {
         if (g_markingTimes)
@@ -151,7 +229,7 @@ class Time
         }
     }
 
-    explicit inline Time(unsigned long long int v)
+    explicit inline NSIM2023_TIME_CONSTEXPR Time(unsigned long long int v)
         : m_data(v)
     {
         if (g_markingTimes)
@@ -184,6 +262,9 @@ class Time
     }
 
 
+#ifdef NSIM2023_TIME_FIXED_RESOLUTION
+    ~Time() = default;
+#else
     ~Time()
     {
         if (g_markingTimes)
@@ -191,6 +272,7 @@ class Time
             Clear(this);
         }
     }
+#endif
 
 
     inline bool IsZero() const
@@ -228,57 +310,57 @@ class Time
         return (m_data < o.m_data) ? -1 : (m_data == o.m_data) ? 0 : 1;
     }
 
-    inline double GetYears() const
+    inline NSIM2023_TIME_CONSTEXPR double GetYears() const
     {
         return ToDouble(Time::Y);
     }
 
-    inline double GetDays() const
+    inline NSIM2023_TIME_CONSTEXPR double GetDays() const
     {
         return ToDouble(Time::D);
     }
 
-    inline double GetHours() const
+    inline NSIM2023_TIME_CONSTEXPR double GetHours() const
     {
         return ToDouble(Time::H);
     }
 
-    inline double GetMinutes() const
+    inline NSIM2023_TIME_CONSTEXPR double GetMinutes() const
     {
         return ToDouble(Time::MIN);
     }
 
-    inline double GetSeconds() const
+    inline NSIM2023_TIME_CONSTEXPR double GetSeconds() const
     {
         return ToDouble(Time::S);
     }
 
-    inline int64_t GetMilliSeconds() const
+    inline NSIM2023_TIME_CONSTEXPR int64_t GetMilliSeconds() const
     {
         return ToInteger(Time::MS);
     }
 
-    inline int64_t GetMicroSeconds() const
+    inline NSIM2023_TIME_CONSTEXPR int64_t GetMicroSeconds() const
     {
         return ToInteger(Time::US);
     }
 
-    inline int64_t GetNanoSeconds() const
+    inline NSIM2023_TIME_CONSTEXPR int64_t GetNanoSeconds() const
     {
         return ToInteger(Time::NS);
     }
 
-    inline int64_t GetPicoSeconds() const
+    inline NSIM2023_TIME_CONSTEXPR int64_t GetPicoSeconds() const
     {
         return ToInteger(Time::PS);
     }
 
-    inline int64_t GetFemtoSeconds() const
+    inline NSIM2023_TIME_CONSTEXPR int64_t GetFemtoSeconds() const
     {
         return ToInteger(Time::FS);
     }
 
-    inline int64_t GetTimeStep() const
+    inline NSIM2023_TIME_CONSTEXPR int64_t GetTimeStep() const
     {
         return m_data;
     }
@@ -293,6 +375,13 @@ class Time
         return GetTimeStep();
     }
 
+    /**
+     * Change the unit of the internal time step, rescaling the Time
+     * values created so far. This must be done before Simulator::Run.
+     *
+     * In builds with NSIM2023_TIME_FIXED_RESOLUTION the resolution is
+     * fixed, and asking for a different unit is a fatal error.
+     */
     static void SetResolution(enum Unit resolution);
 
     static enum Unit GetResolution();
@@ -303,6 +392,46 @@ class Time
     }
 
     // Create Times from values given in the indicated units.
+#ifdef NSIM2023_TIME_FIXED_RESOLUTION
+    inline static constexpr Time FromInteger(uint64_t value, enum Unit unit)
+    {
+        NS_ASSERT_MSG(FIXED_FACTOR[unit].isValid,
+                      "Attempted a conversion from an unavailable unit.");
+
+        if (FIXED_FACTOR[unit].fromMul)
+        {
+            value *= FIXED_FACTOR[unit].factor;
+        }
+        else
+        {
+            value /= FIXED_FACTOR[unit].factor;
+        }
+        return Time(value);
+    }
+
+    /**
+     * The integer part is scaled exactly, only the fractional part goes
+     * through a floating point product, then rounds half away from zero
+     * like int64x64_t::Round().
+     */
+    inline static constexpr Time FromDouble(double value, enum Unit unit)
+    {
+        NS_ASSERT_MSG(FIXED_FACTOR[unit].isValid,
+                      "Attempted a conversion from an unavailable unit.");
+
+        int64_t factor = FIXED_FACTOR[unit].factor;
+        if (FIXED_FACTOR[unit].fromMul)
+        {
+            int64_t integer = static_cast<int64_t>(value);
+            double fraction = (value - integer) * factor;
+            return Time(static_cast<long long>(
+                integer * factor +
+                static_cast<int64_t>(fraction < 0 ? fraction - 0.5 : fraction + 0.5)));
+        }
+        double v = value / factor;
+        return Time(static_cast<long long>(v < 0 ? v - 0.5 : v + 0.5));
+    }
+#else
     inline static Time FromInteger(uint64_t value, enum Unit unit)
     {
         struct Information* info = PeekInformation(unit);
@@ -324,6 +453,7 @@ class Time
     {
         return From(int64x64_t(value), unit);
     }
+#endif
 
     inline static Time From(const int64x64_t& value, enum Unit unit)
     {
@@ -345,6 +475,32 @@ class Time
         return Time(retval);
     }
 
+#ifdef NSIM2023_TIME_FIXED_RESOLUTION
+    inline constexpr int64_t ToInteger(enum Unit unit) const
+    {
+        NS_ASSERT_MSG(FIXED_FACTOR[unit].isValid, "Attempted a conversion to an unavailable unit.");
+
+        return FIXED_FACTOR[unit].fromMul ? m_data / FIXED_FACTOR[unit].factor
+                                          : m_data * FIXED_FACTOR[unit].factor;
+    }
+
+    /**
+     * The whole units are an integer division by a constant, so they are
+     * exact; only the remainder is scaled by the inverse factor.
+     */
+    inline constexpr double ToDouble(enum Unit unit) const
+    {
+        NS_ASSERT_MSG(FIXED_FACTOR[unit].isValid, "Attempted a conversion to an unavailable unit.");
+
+        if (FIXED_FACTOR[unit].fromMul)
+        {
+            int64_t factor = FIXED_FACTOR[unit].factor;
+            return static_cast<double>(m_data / factor) +
+                   static_cast<double>(m_data % factor) * FIXED_FACTOR[unit].inverse;
+        }
+        return static_cast<double>(m_data) * FIXED_FACTOR[unit].factor;
+    }
+#else
     inline int64_t ToInteger(enum Unit unit) const
     {
         struct Information* info = PeekInformation(unit);
@@ -367,6 +523,7 @@ class Time
     {
         return To(unit).GetDouble();
     }
+#endif
 
     inline int64x64_t To(enum Unit unit) const
     {
@@ -395,6 +552,25 @@ class Time
     // Attach a unit to a Time, to facilitate output in a specific unit.
     TimeWithUnit As(const enum Unit unit = Time::AUTO) const;
 
+    /**
+     * Convert \p count Time values to doubles in \p unit.
+     *
+     * The conversion factor is looked up once for the whole array, and
+     * the loop is a plain product or quotient by that factor, which the
+     * compiler can vectorize. The quotients are correctly rounded, while
+     * ToDouble() multiplies by a truncated fixed point inverse, so the
+     * results may differ from ToDouble() in the last bits.
+     */
+    static void ToDoubles(const Time* times, std::size_t count, enum Unit unit, double* values);
+
+    /**
+     * Convert \p count doubles in \p unit to Time values.
+     *
+     * Like FromDouble(), the values are rounded to the nearest time step,
+     * halfway cases away from zero.
+     */
+    static void FromDoubles(const double* values, std::size_t count, enum Unit unit, Time* times);
+
     typedef void (*TracedCallback)(Time value);
 
   private:
@@ -436,10 +612,18 @@ class Time
     /**
      *  Record all instances of Time, so we can rescale them when
      *  the resolution changes.
+     *
+     *  When NSIM2023_TIME_FIXED_RESOLUTION is defined the resolution
+     *  cannot change, nothing is recorded and every Mark()/Clear()
+     *  call in the constructors and destructor compiles away.
      */
     typedef std::set<Time*> MarkedTimes;
 
+#ifdef NSIM2023_TIME_FIXED_RESOLUTION
+    static constexpr MarkedTimes* g_markingTimes = nullptr;
+#else
     static MarkedTimes* g_markingTimes;
+#endif
 
   public:
 
@@ -737,7 +921,7 @@ std::ostream& operator<<(std::ostream& os, const Time& time);
 
 std::istream& operator>>(std::istream& is, Time& time);
 
-inline Time
+inline NSIM2023_TIME_CONSTEXPR Time
 Years(double value)
 {
     return Time::FromDouble(value, Time::Y);
@@ -749,7 +933,7 @@ Years(int64x64_t value)
     return Time::From(value, Time::Y);
 }
 
-inline Time
+inline NSIM2023_TIME_CONSTEXPR Time
 Days(double value)
 {
     return Time::FromDouble(value, Time::D);
@@ -761,7 +945,7 @@ Days(int64x64_t value)
     return Time::From(value, Time::D);
 }
 
-inline Time
+inline NSIM2023_TIME_CONSTEXPR Time
 Hours(double value)
 {
     return Time::FromDouble(value, Time::H);
@@ -773,7 +957,7 @@ Hours(int64x64_t value)
     return Time::From(value, Time::H);
 }
 
-inline Time
+inline NSIM2023_TIME_CONSTEXPR Time
 Minutes(double value)
 {
     return Time::FromDouble(value, Time::MIN);
@@ -785,7 +969,7 @@ Minutes(int64x64_t value)
     return Time::From(value, Time::MIN);
 }
 
-inline Time
+inline NSIM2023_TIME_CONSTEXPR Time
 Seconds(double value)
 {
     return Time::FromDouble(value, Time::S);
@@ -797,7 +981,7 @@ Seconds(int64x64_t value)
     return Time::From(value, Time::S);
 }
 
-inline Time
+inline NSIM2023_TIME_CONSTEXPR Time
 MilliSeconds(uint64_t value)
 {
     return Time::FromInteger(value, Time::MS);
@@ -809,7 +993,7 @@ MilliSeconds(int64x64_t value)
     return Time::From(value, Time::MS);
 }
 
-inline Time
+inline NSIM2023_TIME_CONSTEXPR Time
 MicroSeconds(uint64_t value)
 {
     return Time::FromInteger(value, Time::US);
@@ -821,7 +1005,7 @@ MicroSeconds(int64x64_t value)
     return Time::From(value, Time::US);
 }
 
-inline Time
+inline NSIM2023_TIME_CONSTEXPR Time
 NanoSeconds(uint64_t value)
 {
     return Time::FromInteger(value, Time::NS);
@@ -833,7 +1017,7 @@ NanoSeconds(int64x64_t value)
     return Time::From(value, Time::NS);
 }
 
-inline Time
+inline NSIM2023_TIME_CONSTEXPR Time
 PicoSeconds(uint64_t value)
 {
     return Time::FromInteger(value, Time::PS);
@@ -845,7 +1029,7 @@ PicoSeconds(int64x64_t value)
     return Time::From(value, Time::PS);
 }
 
-inline Time
+inline NSIM2023_TIME_CONSTEXPR Time
 FemtoSeconds(uint64_t value)
 {
     return Time::FromInteger(value, Time::FS);
@@ -858,7 +1042,7 @@ FemtoSeconds(int64x64_t value)
 }
 
 
-inline Time
+inline NSIM2023_TIME_CONSTEXPR Time
 TimeStep(uint64_t ts)
 {
     return Time(ts);
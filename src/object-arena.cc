@@ -0,0 +1,246 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#include "object-arena.h"
+
+#include "abort.h"
+#include "log.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+
+namespace nsim2023
+{
+
+NS_LOG_COMPONENT_DEFINE("ObjectArena");
+
+namespace
+{
+
+/** Granularity and alignment of the blocks, as by std::malloc. */
+constexpr std::size_t ALIGNMENT = alignof(std::max_align_t);
+
+/** Blocks larger than this, header included, come from the heap. */
+constexpr std::size_t MAX_BLOCK = 4096;
+
+/** An arena: chunks, and free lists by block size. */
+struct Arena
+{
+    /** Size of the chunks. */
+    std::size_t chunkSize;
+    /** The chunks. */
+    std::vector<char*> chunks;
+    /** Free space of the last chunk. */
+    char* cursor{nullptr};
+    /** End of the last chunk. */
+    char* end{nullptr};
+    /** Free blocks by size / ALIGNMENT, linked through their first word. */
+    std::vector<void*> freeLists;
+    /** Blocks in use, plus one while the arena is current. */
+    std::atomic<std::size_t> references{1};
+};
+
+/** The header in front of every block. */
+struct alignas(ALIGNMENT) BlockHeader
+{
+    /** The arena of the block, null for the heap. */
+    Arena* arena;
+    /** Size of the block, header included. */
+    std::size_t size;
+};
+
+/** The current arena of the calling thread, once it has allocated. */
+thread_local Arena* t_arena = nullptr;
+
+/** Chunk size of the arenas of the calling thread, 0 while not enabled. */
+thread_local std::size_t t_chunkSize = 0;
+
+/** Drop a reference to an arena, freeing its chunks with the last one. */
+void
+Unref(Arena* arena)
+{
+    if (arena->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        NS_LOG_LOGIC("free " << arena->chunks.size() << " chunks of arena " << arena);
+        for (char* chunk : arena->chunks)
+        {
+            std::free(chunk);
+        }
+        delete arena;
+    }
+}
+
+/** Releases the arena of a thread when it exits. */
+struct ArenaRelease
+{
+    /** Release the arena. */
+    ~ArenaRelease()
+    {
+        ObjectArena::Release();
+    }
+};
+
+/** Releases the arena of the calling thread when it exits. */
+thread_local ArenaRelease t_arenaRelease;
+
+/** Get the current arena of the calling thread, creating it if needed. */
+Arena*
+GetArena()
+{
+    if (t_arena == nullptr)
+    {
+        t_arena = new Arena;
+        t_arena->chunkSize = t_chunkSize;
+        t_arena->freeLists.resize(MAX_BLOCK / ALIGNMENT + 1, nullptr);
+        NS_LOG_LOGIC("new arena " << t_arena);
+    }
+    return t_arena;
+}
+
+/** Allocate a block of \p size bytes from the heap. */
+BlockHeader*
+HeapBlock(std::size_t size)
+{
+    auto header = static_cast<BlockHeader*>(std::malloc(size));
+    if (header == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    header->arena = nullptr;
+    header->size = size;
+    return header;
+}
+
+} // namespace
+
+void
+ObjectArena::Enable(std::size_t chunkSize)
+{
+    NS_LOG_FUNCTION(chunkSize);
+    NS_ABORT_MSG_IF(chunkSize < MAX_BLOCK,
+                    "ObjectArena chunks must hold at least " << MAX_BLOCK << " bytes");
+    if (t_chunkSize != chunkSize)
+    {
+        Release();
+    }
+    t_chunkSize = chunkSize;
+    // Constructed on first use only
+    (void)&t_arenaRelease;
+}
+
+void
+ObjectArena::Disable()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    Release();
+    t_chunkSize = 0;
+}
+
+bool
+ObjectArena::IsEnabled()
+{
+    return t_chunkSize != 0;
+}
+
+void
+ObjectArena::Release()
+{
+    if (t_arena != nullptr)
+    {
+        Arena* arena = t_arena;
+        t_arena = nullptr;
+        Unref(arena);
+    }
+}
+
+std::size_t
+ObjectArena::GetChunkN()
+{
+    return t_arena == nullptr ? 0 : t_arena->chunks.size();
+}
+
+void*
+ObjectArena::Allocate(std::size_t size)
+{
+    std::size_t total = (sizeof(BlockHeader) + size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (t_chunkSize == 0 || total > MAX_BLOCK)
+    {
+        return HeapBlock(total) + 1;
+    }
+    Arena* arena = GetArena();
+    void*& freeList = arena->freeLists[total / ALIGNMENT];
+    BlockHeader* header;
+    if (freeList != nullptr)
+    {
+        header = static_cast<BlockHeader*>(freeList);
+        freeList = *reinterpret_cast<void**>(header + 1);
+    }
+    else
+    {
+        if (static_cast<std::size_t>(arena->end - arena->cursor) < total)
+        {
+            // The rest of the last chunk is left unused
+            char* chunk = static_cast<char*>(std::malloc(arena->chunkSize));
+            if (chunk == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            arena->chunks.push_back(chunk);
+            arena->cursor = chunk;
+            arena->end = chunk + arena->chunkSize;
+        }
+        header = reinterpret_cast<BlockHeader*>(arena->cursor);
+        arena->cursor += total;
+    }
+    header->arena = arena;
+    header->size = total;
+    arena->references.fetch_add(1, std::memory_order_relaxed);
+    return header + 1;
+}
+
+void
+ObjectArena::Deallocate(void* pointer)
+{
+    if (pointer == nullptr)
+    {
+        return;
+    }
+    BlockHeader* header = static_cast<BlockHeader*>(pointer) - 1;
+    Arena* arena = header->arena;
+    if (arena == nullptr)
+    {
+        std::free(header);
+        return;
+    }
+    if (arena == t_arena)
+    {
+        // Only the thread of a current arena reuses its blocks
+        void*& freeList = arena->freeLists[header->size / ALIGNMENT];
+        *reinterpret_cast<void**>(header + 1) = freeList;
+        freeList = header;
+    }
+    Unref(arena);
+}
+
+}
@@ -0,0 +1,106 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#ifndef OBJECT_ARENA_H
+#define OBJECT_ARENA_H
+
+#include <cstddef>
+
+
+namespace nsim2023
+{
+
+/**
+ * Arena allocator of the Objects created by a thread during one simulation.
+ *
+ * While the arena is enabled on a thread, the Objects that thread creates
+ * with CreateObject, ObjectFactory or CopyObject, and the arrays of their
+ * aggregates, are carved one after the other out of large chunks, so that
+ * objects built together, such as those of a node, sit together in memory.
+ * A freed block goes to a free list of its size for reuse; nothing is
+ * given back to the system until the arena is released.
+ *
+ * Simulator::Destroy releases the arena of the calling thread: its chunks
+ * are freed at once, as soon as the last object allocated in them is gone,
+ * which may be right away or when the last Ptr held by the user goes. The
+ * next objects go to a new arena.
+ *
+ * \code
+ *   ObjectArena::Enable();
+ *   BuildScenario();
+ *   Simulator::Run();
+ *   Simulator::Destroy();
+ * \endcode
+ *
+ * Objects may be released on another thread than the one which created
+ * them; their blocks are then only reclaimed with the whole arena.
+ */
+class ObjectArena
+{
+  public:
+    /**
+     * Allocate the Objects of the calling thread in an arena.
+     * \param [in] chunkSize The size in bytes of the chunks of the arena.
+     */
+    static void Enable(std::size_t chunkSize = 1 << 20);
+
+    /**
+     * Allocate the Objects of the calling thread on the heap again; the
+     * current arena is released.
+     */
+    static void Disable();
+
+    /**
+     * Check whether the calling thread allocates its Objects in an arena.
+     * \returns \c true between Enable() and Disable().
+     */
+    static bool IsEnabled();
+
+    /**
+     * Release the current arena of the calling thread, if any; called by
+     * Simulator::Destroy.  The arena stays enabled, with a new arena.
+     */
+    static void Release();
+
+    /**
+     * Get the number of chunks of the current arena of the calling thread.
+     * \returns The number of chunks, 0 if the arena is not enabled.
+     */
+    static std::size_t GetChunkN();
+
+    /**
+     * Allocate a block, from the arena of the calling thread if enabled,
+     * otherwise from the heap.
+     * \param [in] size The size of the block.
+     * \returns The block, aligned as by std::malloc.
+     */
+    static void* Allocate(std::size_t size);
+
+    /**
+     * Free a block returned by Allocate().
+     * \param [in] pointer The block, or null.
+     */
+    static void Deallocate(void* pointer);
+};
+
+}
+
+#endif /* OBJECT_ARENA_H */
@@ -30,7 +30,10 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 
 namespace nsim2023
@@ -125,108 +128,169 @@ ObjectBase::NotifyConstructionCompleted()
     NS_LOG_FUNCTION(this);
 }
 
+/** Unnamed namespace */
+namespace
+{
+
+/** One attribute set by ObjectBase::ConstructSelf. */
+struct ConstructionStep
+{
+    /** Full name of the attribute, `tid::name`. */
+    std::string fullName;
+    /** The attribute is settable at construction. */
+    bool construct;
+    /** The value comes from NS_ATTRIBUTE_DEFAULT. */
+    bool fromEnv;
+    /** The value passes the checker as it is, without conversion. */
+    bool valid;
+    /** Accessor object. */
+    Ptr<const AttributeAccessor> accessor;
+    /** Checker object. */
+    Ptr<const AttributeChecker> checker;
+    /** The value when the construction list has none. */
+    Ptr<const AttributeValue> value;
+};
+
+/** The attributes ObjectBase::ConstructSelf sets for a type. */
+struct ConstructionPlan
+{
+    /** TypeId::GetAttributeGeneration() when the plan was built. */
+    uint64_t generation{0};
+    /** \c true once built. */
+    bool built{false};
+    /** The attributes of the type and its parents, in the order they are set. */
+    std::vector<ConstructionStep> steps;
+};
+
 /**
- * \def LOG_WHERE_VALUE(where, value)
- * Log where and what value we find for the attribute
- * \param where The source of the value
- * \param value The value found, or "nothing"
+ * Get the construction plan of a type, building it on first use and again
+ * after Config::SetDefault.  Each thread keeps its own plans, so that
+ * using them needs no lock.
+ * \param [in] tid The type.
+ * \returns The construction plan.
  */
-#ifdef NS3_LOG_ENABLE
-#define LOG_WHERE_VALUE(where, value)                                                              \
-    do                                                                                             \
-    {                                                                                              \
-        std::string valStr{"nothing"};                                                             \
-        if (value)                                                                                 \
-        {                                                                                          \
-            valStr = "\"" + value->SerializeToString(info.checker) + "\"";                         \
-        }                                                                                          \
-        NS_LOG_DEBUG(where << " gave " << valStr);                                                 \
-    } while (false)
-#else
-#define LOG_WHERE_VALUE(where, value)
-#endif
-
-void
-ObjectBase::ConstructSelf(const AttributeConstructionList& attributes)
+const ConstructionPlan&
+GetConstructionPlan(TypeId tid)
 {
-    // loop over the inheritance tree back to the Object base class.
-    NS_LOG_FUNCTION(this << &attributes);
-    TypeId tid = GetInstanceTypeId();
+    // Not moved by a resize, as objects may be constructed while a plan runs
+    thread_local std::vector<std::unique_ptr<ConstructionPlan>> plans;
+    uint64_t generation = TypeId::GetAttributeGeneration();
+    uint16_t uid = tid.GetUid();
+    if (plans.size() <= uid)
+    {
+        plans.resize(uid + 1);
+    }
+    if (!plans[uid])
+    {
+        plans[uid].reset(new ConstructionPlan);
+    }
+    ConstructionPlan& plan = *plans[uid];
+    if (plan.built && plan.generation == generation)
+    {
+        return plan;
+    }
+
+    // EnvDictionary isn't thread safe
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    NS_LOG_DEBUG("plan construction of tid=" << tid.GetName());
+    plan.steps.clear();
     do // Do this tid and all parents
     {
-        // loop over all attributes in object type
-        NS_LOG_DEBUG("construct tid=" << tid.GetName() << ", params=" << tid.GetAttributeN());
-        for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+        for (std::size_t i = 0; i < tid.GetAttributeN(); i++)
         {
             struct TypeId::AttributeInformation info = tid.GetAttribute(i);
-            NS_LOG_DEBUG("try to construct \"" << tid.GetName() << "::" << info.name << "\"");
-
-            Ptr<const AttributeValue> value = attributes.Find(info.checker);
-            std::string where = "argument";
-
-            LOG_WHERE_VALUE(where, value);
-            // See if this attribute should not be set here in the
-            // constructor.
-            if (!(info.flags & TypeId::ATTR_CONSTRUCT))
+            ConstructionStep step;
+            step.fullName = tid.GetAttributeFullName(i);
+            step.construct = (info.flags & TypeId::ATTR_CONSTRUCT) != 0;
+            step.fromEnv = false;
+            step.accessor = info.accessor;
+            step.checker = info.checker;
+            if (step.construct)
             {
-                // Handle this attribute if it should not be
-                // set here.
-                if (!value)
+                auto [found, val] = EnvDictionary(step.fullName);
+                if (found)
                 {
-                    // Skip this attribute if it's not in the
-                    // AttributeConstructionList.
-                    NS_LOG_DEBUG("skipping, not settable at construction");
-                    continue;
+                    step.value = Create<StringValue>(val);
+                    step.fromEnv = true;
                 }
                 else
                 {
-                    // This is an error because this attribute is not
-                    // settable in its constructor but is present in
-                    // the AttributeConstructionList.
-                    NS_FATAL_ERROR("Attribute name="
-                                   << info.name << " tid=" << tid.GetName()
-                                   << ": initial value cannot be set using attributes");
+                    // Set from Tid initialValue, which is guaranteed to exist
+                    step.value = info.initialValue;
                 }
             }
+            // Values that need a conversion, such as strings naming an
+            // object to create, are still converted for each object
+            step.valid = step.value && step.checker->Check(*step.value);
+            plan.steps.push_back(step);
+        }
+        tid = tid.GetParent();
+    } while (tid != ObjectBase::GetTypeId());
+    plan.generation = generation;
+    plan.built = true;
+    return plan;
+}
 
-            if (!value)
-            {
-                auto [found, val] = EnvDictionary(tid.GetAttributeFullName(i));
-                if (found)
-                {
-                    value = Create<StringValue>(val);
-                    where = "env var";
-                    LOG_WHERE_VALUE(where, value);
-                }
-            }
+} // namespace
 
-            bool initial = false;
+void
+ObjectBase::ConstructSelf(const AttributeConstructionList& attributes)
+{
+    NS_LOG_FUNCTION(this << &attributes);
+    TypeId tid = GetInstanceTypeId();
+    const ConstructionPlan& plan = GetConstructionPlan(tid);
+    NS_LOG_DEBUG("construct tid=" << tid.GetName() << ", params=" << plan.steps.size());
+    bool arguments = attributes.Begin() != attributes.End();
+    for (const ConstructionStep& step : plan.steps)
+    {
+        Ptr<const AttributeValue> value;
+        if (arguments)
+        {
+            value = attributes.Find(step.checker);
+        }
+        // See if this attribute should not be set here in the
+        // constructor.
+        if (!step.construct)
+        {
             if (!value)
             {
-                // Set from Tid initialValue, which is guaranteed to exist
-                value = info.initialValue;
-                where = "initial value";
-                initial = true;
-                LOG_WHERE_VALUE(where, value);
+                // Skip this attribute if it's not in the
+                // AttributeConstructionList.
+                continue;
             }
+            // This is an error because this attribute is not
+            // settable in its constructor but is present in
+            // the AttributeConstructionList.
+            NS_FATAL_ERROR("Attribute name=" << step.fullName
+                                             << ": initial value cannot be set using attributes");
+        }
 
-            if (DoSet(info.accessor, info.checker, *value) || initial)
+        if (value)
+        {
+            if (DoSet(step.accessor, step.checker, *value))
             {
-                // Setting from initial value may fail, e.g. setting
-                // ObjectVectorValue from ""
-                // That's ok, so we still report success since construction is complete
-                NS_LOG_DEBUG("construct \"" << tid.GetName() << "::" << info.name << "\" from "
-                                            << where);
+                NS_LOG_DEBUG("construct \"" << step.fullName << "\" from argument");
             }
-
-        } // for i attributes
-        tid = tid.GetParent();
-    } while (tid != ObjectBase::GetTypeId());
+        }
+        else if (step.valid)
+        {
+            // Setting from initial value may fail, e.g. setting
+            // ObjectVectorValue from ""
+            // That's ok, so we still report success since construction is complete
+            step.accessor->Set(this, *step.value);
+            NS_LOG_DEBUG("construct \"" << step.fullName << "\" from "
+                                        << (step.fromEnv ? "env var" : "initial value"));
+        }
+        else if (DoSet(step.accessor, step.checker, *step.value) || !step.fromEnv)
+        {
+            NS_LOG_DEBUG("construct \"" << step.fullName << "\" from "
+                                        << (step.fromEnv ? "env var" : "initial value"));
+        }
+    } // for steps
     NotifyConstructionCompleted();
 }
 
-#undef LOG_WHERE_VALUE
-
 bool
 ObjectBase::DoSet(Ptr<const AttributeAccessor> accessor,
                   Ptr<const AttributeChecker> checker,
@@ -23,6 +23,8 @@
 
 #include "log.h"
 
+#include <algorithm>
+
 
 namespace nsim2023
 {
@@ -134,6 +136,51 @@ ObjectPtrContainerAccessor::Get(const ObjectBase* object, AttributeValue& value)
     return true;
 }
 
+bool
+ObjectPtrContainerAccessor::GetIf(const ObjectBase* object,
+                                  const std::function<bool(std::size_t)>& accept,
+                                  std::vector<std::pair<std::size_t, Ptr<Object>>>* instances) const
+{
+    NS_LOG_FUNCTION(this << object << instances);
+    instances->clear();
+    std::size_t n;
+    bool ok = DoGetN(object, &n);
+    if (!ok)
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < n; i++)
+    {
+        std::size_t index;
+        Ptr<Object> o = DoGet(object, i, &index);
+        if (accept(index))
+        {
+            instances->emplace_back(index, o);
+        }
+    }
+    auto byIndex = [](const std::pair<std::size_t, Ptr<Object>>& a,
+                      const std::pair<std::size_t, Ptr<Object>>& b) { return a.first < b.first; };
+    if (!std::is_sorted(instances->begin(), instances->end(), byIndex))
+    {
+        std::stable_sort(instances->begin(), instances->end(), byIndex);
+    }
+    // Like Get, keep the last instance of an index
+    auto last = instances->begin();
+    for (auto it = instances->begin(); it != instances->end(); ++it)
+    {
+        if (it + 1 == instances->end() || (it + 1)->first != it->first)
+        {
+            if (last != it)
+            {
+                *last = std::move(*it);
+            }
+            ++last;
+        }
+    }
+    instances->erase(last, instances->end());
+    return true;
+}
+
 bool
 ObjectPtrContainerAccessor::HasGetter() const
 {
@@ -26,7 +26,10 @@
 #include "object.h"
 #include "ptr.h"
 
+#include <functional>
 #include <map>
+#include <utility>
+#include <vector>
 
 
 namespace nsim2023
@@ -159,6 +162,19 @@ class ObjectPtrContainerAccessor : public AttributeAccessor
     bool HasGetter() const override;
     bool HasSetter() const override;
 
+    /**
+     * Get the instances whose index passes a filter, in index order, as
+     * Get would store them but without copying the whole container.
+     *
+     * \param [in] object The object holding the container.
+     * \param [in] accept The filter of indices.
+     * \param [out] instances The accepted indices and instances.
+     * \returns \c true if the container could be read.
+     */
+    bool GetIf(const ObjectBase* object,
+               const std::function<bool(std::size_t)>& accept,
+               std::vector<std::pair<std::size_t, Ptr<Object>>>* instances) const;
+
   private:
 
     /**
@@ -24,9 +24,11 @@
 #include "assert.h"
 #include "attribute.h"
 #include "log.h"
+#include "object-arena.h"
 #include "object-factory.h"
 #include "nsim-string.h"
 
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <sstream>
@@ -45,6 +47,9 @@ NS_LOG_COMPONENT_DEFINE("Object");
 
 NS_OBJECT_ENSURE_REGISTERED(Object);
 
+/** Incremented by every AggregateObject. */
+static std::atomic<uint64_t> g_aggregationGeneration{0};
+
 Object::AggregateIterator::AggregateIterator()
     : m_object(nullptr),
       m_current(0)
@@ -93,11 +98,11 @@ Object::Object()
     : m_tid(Object::GetTypeId()),
       m_disposed(false),
       m_initialized(false),
-      m_aggregates((struct Aggregates*)std::malloc(sizeof(struct Aggregates))),
-      m_getObjectCount(0)
+      m_aggregates((struct Aggregates*)ObjectArena::Allocate(sizeof(struct Aggregates)))
 {
     NS_LOG_FUNCTION(this);
     m_aggregates->n = 1;
+    m_aggregates->index = nullptr;
     m_aggregates->buffer[0] = this;
 }
 
@@ -118,22 +123,40 @@ Object::~Object()
         }
     }
     // finally, if all objects have been removed from the list,
-    // delete the aggregate list
+    // delete the aggregate list; otherwise forget the lookups, which
+    // may have found this object
     if (m_aggregates->n == 0)
     {
-        std::free(m_aggregates);
+        FreeAggregates(m_aggregates);
+    }
+    else
+    {
+        ObjectArena::Deallocate(m_aggregates->index);
+        m_aggregates->index = nullptr;
     }
     m_aggregates = nullptr;
 }
 
+void*
+Object::operator new(std::size_t size)
+{
+    return ObjectArena::Allocate(size);
+}
+
+void
+Object::operator delete(void* pointer)
+{
+    ObjectArena::Deallocate(pointer);
+}
+
 Object::Object(const Object& o)
     : m_tid(o.m_tid),
       m_disposed(false),
       m_initialized(false),
-      m_aggregates((struct Aggregates*)std::malloc(sizeof(struct Aggregates))),
-      m_getObjectCount(0)
+      m_aggregates((struct Aggregates*)ObjectArena::Allocate(sizeof(struct Aggregates)))
 {
     m_aggregates->n = 1;
+    m_aggregates->index = nullptr;
     m_aggregates->buffer[0] = this;
 }
 
@@ -144,7 +167,7 @@ Object::Construct(const AttributeConstructionList& attributes)
     ConstructSelf(attributes);
 }
 
-Ptr<Object>
+Object*
 Object::DoGetObject(TypeId tid) const
 {
     NS_LOG_FUNCTION(this << tid);
@@ -152,6 +175,7 @@ Object::DoGetObject(TypeId tid) const
 
     uint32_t n = m_aggregates->n;
     TypeId objectTid = Object::GetTypeId();
+    Object* found = nullptr;
     for (uint32_t i = 0; i < n; i++)
     {
         Object* current = m_aggregates->buffer[i];
@@ -162,15 +186,70 @@ Object::DoGetObject(TypeId tid) const
         }
         if (cur == tid)
         {
-            // first, increment the access count
-            current->m_getObjectCount++;
-            // then, update the sort
-            UpdateSortedArray(m_aggregates, i);
-            // finally, return the match
-            return const_cast<Object*>(current);
+            found = current;
+            break;
+        }
+    }
+    IndexAggregate(tid.GetUid(), found);
+    return found;
+}
+
+void
+Object::IndexAggregate(uint16_t uid, Object* object) const
+{
+    NS_LOG_FUNCTION(this << uid << object);
+    struct AggregateIndex* index = m_aggregates->index;
+    if (index == nullptr || 2 * (index->size + 1) > index->mask + 1)
+    {
+        // Keep the table at most half full
+        uint32_t capacity = index == nullptr ? 8 : 2 * (index->mask + 1);
+        auto grown = (struct AggregateIndex*)ObjectArena::Allocate(
+            sizeof(struct AggregateIndex) + (capacity - 1) * sizeof(AggregateIndex::Entry));
+        grown->mask = capacity - 1;
+        grown->size = 0;
+        for (uint32_t i = 0; i < capacity; i++)
+        {
+            grown->entries[i].uid = 0;
         }
+        if (index != nullptr)
+        {
+            for (uint32_t i = 0; i <= index->mask; i++)
+            {
+                if (index->entries[i].uid != 0)
+                {
+                    uint32_t j = index->entries[i].uid & grown->mask;
+                    while (grown->entries[j].uid != 0)
+                    {
+                        j = (j + 1) & grown->mask;
+                    }
+                    grown->entries[j] = index->entries[i];
+                    grown->size++;
+                }
+            }
+            ObjectArena::Deallocate(index);
+        }
+        index = grown;
+        m_aggregates->index = grown;
+    }
+    uint32_t i = uid & index->mask;
+    while (index->entries[i].uid != 0 && index->entries[i].uid != uid)
+    {
+        i = (i + 1) & index->mask;
+    }
+    if (index->entries[i].uid == 0)
+    {
+        index->size++;
     }
-    return nullptr;
+    index->entries[i].uid = uid;
+    index->entries[i].object = object;
+}
+
+void
+Object::FreeAggregates(struct Aggregates* aggregates)
+{
+    NS_LOG_FUNCTION(aggregates);
+    ObjectArena::Deallocate(aggregates->index);
+    ObjectArena::Deallocate(aggregates);
 }
 
 void
@@ -216,20 +295,6 @@ restart:
     }
 }
 
-void
-Object::UpdateSortedArray(struct Aggregates* aggregates, uint32_t j) const
-{
-    NS_LOG_FUNCTION(this << aggregates << j);
-    while (j > 0 &&
-           aggregates->buffer[j]->m_getObjectCount > aggregates->buffer[j - 1]->m_getObjectCount)
-    {
-        Object* tmp = aggregates->buffer[j - 1];
-        aggregates->buffer[j - 1] = aggregates->buffer[j];
-        aggregates->buffer[j] = tmp;
-        j--;
-    }
-}
-
 void
 Object::AggregateObject(Ptr<Object> o)
 {
@@ -242,9 +307,10 @@ Object::AggregateObject(Ptr<Object> o)
     Object* other = PeekPointer(o);
     // first create the new aggregate buffer.
     uint32_t total = m_aggregates->n + other->m_aggregates->n;
-    struct Aggregates* aggregates =
-        (struct Aggregates*)std::malloc(sizeof(struct Aggregates) + (total - 1) * sizeof(Object*));
+    struct Aggregates* aggregates = (struct Aggregates*)ObjectArena::Allocate(
+        sizeof(struct Aggregates) + (total - 1) * sizeof(Object*));
     aggregates->n = total;
+    aggregates->index = nullptr;
 
     // copy our buffer to the new buffer
     std::memcpy(&aggregates->buffer[0],
@@ -262,7 +328,6 @@ Object::AggregateObject(Ptr<Object> o)
                            "Multiple aggregation of objects of type "
                            << other->GetInstanceTypeId() << " on objects of type " << typeId);
         }
-        UpdateSortedArray(aggregates, m_aggregates->n + i);
     }
 
     // keep track of the old aggregate buffers for the iteration
@@ -277,6 +342,7 @@ Object::AggregateObject(Ptr<Object> o)
         Object* current = aggregates->buffer[i];
         current->m_aggregates = aggregates;
     }
+    g_aggregationGeneration++;
 
     // Finally, call NotifyNewAggregate on all the objects aggregates together.
     // We purposely use the old aggregate buffers to iterate over the objects
@@ -295,8 +361,8 @@ Object::AggregateObject(Ptr<Object> o)
     }
 
     // Now that we are done with them, we can free our old aggregate buffers
-    std::free(a);
-    std::free(b);
+    FreeAggregates(a);
+    FreeAggregates(b);
 }
 
 /**
@@ -309,6 +375,12 @@ Object::NotifyNewAggregate()
     NS_LOG_FUNCTION(this);
 }
 
+uint64_t
+Object::GetAggregationGeneration()
+{
+    return g_aggregationGeneration.load(std::memory_order_relaxed);
+}
+
 Object::AggregateIterator
 Object::GetAggregateIterator() const
 {
@@ -27,6 +27,7 @@
 #include "ptr.h"
 #include "simple-ref-count.h"
 
+#include <cstddef>
 #include <stdint.h>
 #include <string>
 #include <vector>
@@ -94,6 +95,20 @@ class Object : public SimpleRefCount<Object, ObjectBase, ObjectDeleter>
     /** Destructor. */
     ~Object() override;
 
+    /**
+     * Allocate an Object, in the ObjectArena of the calling thread if it
+     * is enabled.
+     * \param [in] size The size of the Object.
+     * \returns The memory of the Object.
+     */
+    static void* operator new(std::size_t size);
+
+    /**
+     * Free the memory of an Object.
+     * \param [in] pointer The memory of the Object.
+     */
+    static void operator delete(void* pointer);
+
     TypeId GetInstanceTypeId() const override;
 
     template <typename T>
@@ -106,6 +121,12 @@ class Object : public SimpleRefCount<Object, ObjectBase, ObjectDeleter>
 
     void AggregateObject(Ptr<Object> other);
 
+    /**
+     * Get the number of aggregations done so far, by any object.
+     * \return The aggregation generation.
+     */
+    static uint64_t GetAggregationGeneration();
+
 
     AggregateIterator GetAggregateIterator() const;
 
@@ -203,6 +224,32 @@ class Object : public SimpleRefCount<Object, ObjectBase, ObjectDeleter>
     friend struct ObjectDeleter;
 
 
+    /**
+     * The aggregate matching a TypeId, by TypeId uid.
+     *
+     * An open addressing hash table with linear probing, shared by all the
+     * aggregated Objects like their Aggregates, and rebuilt from scratch
+     * when the aggregation changes.  Misses are recorded too.
+     */
+    struct AggregateIndex
+    {
+        /** An entry of the table. */
+        struct Entry
+        {
+            /** The uid of the TypeId looked up, 0 for an empty entry. */
+            uint16_t uid;
+            /** The aggregate of that TypeId, or null. */
+            Object* object;
+        };
+
+        /** The number of entries minus one; the number is a power of two. */
+        uint32_t mask;
+        /** The number of entries in use. */
+        uint32_t size;
+        /** The entries. */
+        Entry entries[1];
+    };
+
     /**
      * The list of Objects aggregated to this one.
      *
@@ -218,14 +265,25 @@ class Object : public SimpleRefCount<Object, ObjectBase, ObjectDeleter>
     {
         /** The number of entries in buffer. */
         uint32_t n;
+        /** The results of DoGetObject() by TypeId, built as they come. */
+        struct AggregateIndex* index;
         /** The array of Objects. */
         Object* buffer[1];
     };
 
+    /**
+     * Find an Object of TypeId tid in the aggregates of this Object,
+     * through the index if it has seen tid.
+     *
+     * \param [in] tid The TypeId we're looking for.
+     * \returns The matching Object, if it is found.
+     */
+    inline Object* FindAggregate(TypeId tid) const;
+
     /**
      * Find an Object of TypeId tid in the aggregates of this Object.
      */
-    Ptr<Object> DoGetObject(TypeId tid) const;
+    Object* DoGetObject(TypeId tid) const;
 
     /**
      * Verify that this Object is still live, by checking it's reference count.
@@ -245,9 +303,19 @@ class Object : public SimpleRefCount<Object, ObjectBase, ObjectDeleter>
     void Construct(const AttributeConstructionList& attributes);
 
     /**
-     * Keep the list of aggregates in most-recently-used order
+     * Record the result of a lookup in the index of the aggregates.
+     *
+     * \param [in] uid The uid of the TypeId looked up.
+     * \param [in] object The matching Object, or null.
      */
-    void UpdateSortedArray(struct Aggregates* aggregates, uint32_t i) const;
+    void IndexAggregate(uint16_t uid, Object* object) const;
+
+    /**
+     * Free an Aggregates and its index.
+     *
+     * \param [in] aggregates The Aggregates.
+     */
+    static void FreeAggregates(struct Aggregates* aggregates);
 
     /**
      * Attempt to delete this Object.
@@ -275,14 +343,6 @@ class Object : public SimpleRefCount<Object, ObjectBase, ObjectDeleter>
      * so the size of the array is indirectly a reference count.
      */
     struct Aggregates* m_aggregates;
-    /**
-     * The number of times the Object was accessed with a
-     * call to GetObject().
-     *
-     * This integer is used to implement a heuristic to sort
-     * the array of aggregates in most-frequently accessed order.
-     */
-    uint32_t m_getObjectCount;
 };
 
 template <typename T>
@@ -304,27 +364,40 @@ ObjectDeleter::Delete(Object* object)
     object->DoDelete();
 }
 
+Object*
+Object::FindAggregate(TypeId tid) const
+{
+    uint16_t uid = tid.GetUid();
+    const struct AggregateIndex* index = m_aggregates->index;
+    if (index != nullptr)
+    {
+        for (uint32_t i = uid & index->mask; index->entries[i].uid != 0; i = (i + 1) & index->mask)
+        {
+            if (index->entries[i].uid == uid)
+            {
+                return index->entries[i].object;
+            }
+        }
+    }
+    return DoGetObject(tid);
+}
+
 template <typename T>
 Ptr<T>
 Object::GetObject() const
 {
-    // This is an optimization: if the cast works (which is likely),
-    // things will be pretty fast.
-    T* result = dynamic_cast<T*>(m_aggregates->buffer[0]);
-    if (result != nullptr)
-    {
-        return Ptr<T>(result);
-    }
-    // if the cast does not work, we try to do a full type check.
-    Ptr<Object> found = DoGetObject(T::GetTypeId());
-    if (found)
+    Object* found = FindAggregate(T::GetTypeId());
+    if (found != nullptr)
     {
-        return Ptr<T>(static_cast<T*>(PeekPointer(found)));
+        NS_ASSERT_MSG(dynamic_cast<T*>(found) != nullptr,
+                      "GetObject(): " << found->GetInstanceTypeId()
+                                      << " is no match for the requested type, which may not "
+                                         "define its own GetTypeId()");
+        return Ptr<T>(static_cast<T*>(found));
     }
     return nullptr;
 }
 
-
 template <>
 inline Ptr<Object>
 Object::GetObject() const
@@ -336,10 +409,10 @@ template <typename T>
 Ptr<T>
 Object::GetObject(TypeId tid) const
 {
-    Ptr<Object> found = DoGetObject(tid);
-    if (found)
+    Object* found = FindAggregate(tid);
+    if (found != nullptr)
     {
-        return Ptr<T>(static_cast<T*>(PeekPointer(found)));
+        return Ptr<T>(static_cast<T*>(found));
     }
     return nullptr;
 }
@@ -355,7 +428,7 @@ Object::GetObject(TypeId tid) const
     }
     else
     {
-        return DoGetObject(tid);
+        return FindAggregate(tid);
     }
 }
 
@@ -0,0 +1,207 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#include "philox-stream.h"
+
+#include "fatal-error.h"
+
+
+namespace nsim2023
+{
+
+namespace
+{
+
+/** Philox4x32 multipliers. */
+const uint32_t PHILOX_M0 = 0xD2511F53;
+const uint32_t PHILOX_M1 = 0xCD9E8D57;
+/** Philox4x32 key increments (Weyl sequence). */
+const uint32_t PHILOX_W0 = 0x9E3779B9;
+const uint32_t PHILOX_W1 = 0xBB67AE85;
+/** Number of rounds. */
+const int PHILOX_ROUNDS = 10;
+
+} // namespace
+
+PhiloxStream::PhiloxStream(uint32_t seed, uint64_t stream, uint64_t substream)
+    : m_stream(stream),
+      m_position(0),
+      m_cachedBlock(0),
+      m_cached(false)
+{
+    if (seed == 0)
+    {
+        NS_FATAL_ERROR("invalid Seed " << seed);
+    }
+    if (substream >> 32)
+    {
+        NS_FATAL_ERROR("invalid substream " << substream << " for Philox4x32, must fit in 32 bits");
+    }
+    m_key[0] = seed;
+    m_key[1] = static_cast<uint32_t>(substream);
+}
+
+void
+PhiloxStream::Block(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4])
+{
+    uint32_t c0 = counter[0];
+    uint32_t c1 = counter[1];
+    uint32_t c2 = counter[2];
+    uint32_t c3 = counter[3];
+    uint32_t k0 = key[0];
+    uint32_t k1 = key[1];
+    for (int round = 0; round < PHILOX_ROUNDS; ++round)
+    {
+        uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * c0;
+        uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * c2;
+        uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n1 = static_cast<uint32_t>(p1);
+        uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        uint32_t n3 = static_cast<uint32_t>(p0);
+        c0 = n0;
+        c1 = n1;
+        c2 = n2;
+        c3 = n3;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    result[0] = c0;
+    result[1] = c1;
+    result[2] = c2;
+    result[3] = c3;
+}
+
+void
+PhiloxStream::StreamBlock(uint64_t block, uint32_t result[4]) const
+{
+    const uint32_t counter[4] = {static_cast<uint32_t>(block),
+                                 static_cast<uint32_t>(block >> 32),
+                                 static_cast<uint32_t>(m_stream),
+                                 static_cast<uint32_t>(m_stream >> 32)};
+    Block(counter, m_key, result);
+}
+
+double
+PhiloxStream::ToU01(uint32_t high, uint32_t low)
+{
+    // 52 random bits, centered in their interval: never 0 nor 1
+    uint64_t bits = (static_cast<uint64_t>(high) << 20) | (low >> 12);
+    return (bits + 0.5) * (1.0 / 4503599627370496.0);
+}
+
+double
+PhiloxStream::RandU01()
+{
+    uint64_t block = m_position >> 1;
+    if (!m_cached || block != m_cachedBlock)
+    {
+        StreamBlock(block, m_cache);
+        m_cachedBlock = block;
+        m_cached = true;
+    }
+    int word = (m_position & 1) * 2;
+    m_position++;
+    return ToU01(m_cache[word], m_cache[word + 1]);
+}
+
+void
+PhiloxStream::Fill(double* values, std::size_t count)
+{
+    std::size_t i = 0;
+    // Finish the current block, then go by whole blocks
+    if (count > 0 && (m_position & 1))
+    {
+        values[i++] = RandU01();
+    }
+    // Four blocks side by side: the rounds of the blocks are independent
+    const int lanes = 4;
+    for (; i + 2 * lanes <= count; i += 2 * lanes)
+    {
+        uint32_t c[4][lanes];
+        uint64_t block = m_position >> 1;
+        for (int j = 0; j < lanes; ++j)
+        {
+            c[0][j] = static_cast<uint32_t>(block + j);
+            c[1][j] = static_cast<uint32_t>((block + j) >> 32);
+            c[2][j] = static_cast<uint32_t>(m_stream);
+            c[3][j] = static_cast<uint32_t>(m_stream >> 32);
+        }
+        uint32_t k0 = m_key[0];
+        uint32_t k1 = m_key[1];
+        for (int round = 0; round < PHILOX_ROUNDS; ++round)
+        {
+            for (int j = 0; j < lanes; ++j)
+            {
+                uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * c[0][j];
+                uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * c[2][j];
+                uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c[1][j] ^ k0;
+                uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c[3][j] ^ k1;
+                c[0][j] = n0;
+                c[1][j] = static_cast<uint32_t>(p1);
+                c[2][j] = n2;
+                c[3][j] = static_cast<uint32_t>(p0);
+            }
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+        for (int j = 0; j < lanes; ++j)
+        {
+            values[i + 2 * j] = ToU01(c[0][j], c[1][j]);
+            values[i + 2 * j + 1] = ToU01(c[2][j], c[3][j]);
+        }
+        m_position += 2 * lanes;
+    }
+    for (; i + 1 < count; i += 2)
+    {
+        uint32_t result[4];
+        StreamBlock(m_position >> 1, result);
+        values[i] = ToU01(result[0], result[1]);
+        values[i + 1] = ToU01(result[2], result[3]);
+        m_position += 2;
+    }
+    if (i < count)
+    {
+        values[i] = RandU01();
+    }
+}
+
+double
+PhiloxStream::GetU01(uint64_t index) const
+{
+    uint32_t result[4];
+    StreamBlock(index >> 1, result);
+    int word = (index & 1) * 2;
+    return ToU01(result[word], result[word + 1]);
+}
+
+void
+PhiloxStream::SetPosition(uint64_t index)
+{
+    m_position = index;
+}
+
+uint64_t
+PhiloxStream::GetPosition() const
+{
+    return m_position;
+}
+
+}
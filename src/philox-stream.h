@@ -0,0 +1,106 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#ifndef PHILOX_STREAM_H
+#define PHILOX_STREAM_H
+
+#include "rng-engine.h"
+
+#include <cstddef>
+#include <stdint.h>
+
+
+namespace nsim2023
+{
+
+/**
+ * Counter-based Philox4x32-10 generator.
+ *
+ * Philox is described in:
+ * J. K. Salmon, M. A. Moraes, R. O. Dror and D. E. Shaw, "Parallel
+ * random numbers: as easy as 1, 2, 3", SC 2011.
+ *
+ * The key is made of the seed and the substream (run) number, and the
+ * counter of the stream number and of the position in the stream. Number i
+ * of a stream is thus a pure function of (seed, run, stream, i) and can be
+ * computed directly with GetU01(), without stepping through the numbers
+ * before it.
+ */
+class PhiloxStream : public RngEngine
+{
+  public:
+    /**
+     * \p substream must fit in 32 bits.
+     */
+    PhiloxStream(uint32_t seed, uint64_t stream, uint64_t substream);
+
+    double RandU01() override;
+
+    void Fill(double* values, std::size_t count) override;
+
+    /**
+     * Get number \p index of this stream, without changing the position.
+     */
+    double GetU01(uint64_t index) const;
+
+    /**
+     * Set the index of the number returned by the next RandU01().
+     */
+    void SetPosition(uint64_t index);
+
+    /**
+     * Get the index of the number returned by the next RandU01().
+     */
+    uint64_t GetPosition() const;
+
+    /**
+     * Compute one Philox4x32-10 block.
+     */
+    static void Block(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]);
+
+  private:
+    /**
+     * Compute the block holding the numbers 2 x \p block and 2 x \p block + 1.
+     */
+    void StreamBlock(uint64_t block, uint32_t result[4]) const;
+
+    /**
+     * Convert two 32 bit words to a double in (0,1).
+     */
+    static double ToU01(uint32_t high, uint32_t low);
+
+    /** Seed and substream number. */
+    uint32_t m_key[2];
+    /** Stream number. */
+    uint64_t m_stream;
+    /** Index of the next number. */
+    uint64_t m_position;
+    /** Block m_cachedBlock, valid if m_cached is true. */
+    uint32_t m_cache[4];
+    /** Index of the block in m_cache. */
+    uint64_t m_cachedBlock;
+    /** Whether m_cache holds a block. */
+    bool m_cached;
+};
+
+}
+
+#endif /* PHILOX_STREAM_H */
@@ -21,12 +21,14 @@
 
 #include "random-variable-stream.h"
 
+#include "abort.h"
 #include "assert.h"
 #include "boolean.h"
 #include "double.h"
 #include "integer.h"
 #include "log.h"
 #include "pointer.h"
+#include "rng-engine.h"
 #include "rng-seed-manager.h"
 #include "rng-stream.h"
 #include "nsim-string.h"
@@ -34,6 +36,7 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <memory>
 
 
 namespace nsim2023
@@ -43,6 +46,266 @@ NS_LOG_COMPONENT_DEFINE("RandomVariableStream");
 
 NS_OBJECT_ENSURE_REGISTERED(RandomVariableStream);
 
+namespace
+{
+
+/**
+ * The last automatically assigned stream, at its start state, with the
+ * seed and run it was created for. Automatic stream indices are handed out
+ * consecutively, so the next one is a single jump away from it.
+ */
+struct LastAutomaticStream
+{
+    std::unique_ptr<RngStream> rng; //!< Start state of the stream
+    uint32_t seed;                  //!< Seed the stream was created for
+    uint64_t run;                   //!< Run the stream was created for
+    uint64_t index;                 //!< Index of the stream
+};
+
+/**
+ * Create the generator of an automatically assigned stream.
+ */
+RngStream*
+CreateAutomaticStream(uint32_t seed, uint64_t run, uint64_t index)
+{
+    // One per thread: threads building nodes in their own RngStreamPartition
+    // each walk a run of consecutive indices.
+    static thread_local LastAutomaticStream last;
+    if (last.rng && last.seed == seed && last.run == run && last.index + 1 == index)
+    {
+        last.rng->AdvanceStreams(1);
+    }
+    else
+    {
+        last.rng.reset(new RngStream(seed, index, run));
+        last.seed = seed;
+        last.run = run;
+    }
+    last.index = index;
+    return new RngStream(*last.rng);
+}
+
+/** Ziggurat: number of layers of the normal ziggurat. */
+const int ZIGGURAT_NORMAL_LAYERS = 128;
+/** Ziggurat: start of the tail of the normal ziggurat. */
+const double ZIGGURAT_NORMAL_R = 3.442619855899;
+/** Ziggurat: area of each layer of the normal ziggurat. */
+const double ZIGGURAT_NORMAL_V = 9.91256303526217e-3;
+/** Ziggurat: number of layers of the exponential ziggurat. */
+const int ZIGGURAT_EXPONENTIAL_LAYERS = 256;
+/** Ziggurat: start of the tail of the exponential ziggurat. */
+const double ZIGGURAT_EXPONENTIAL_R = 7.69711747013104972;
+/** Ziggurat: area of each layer of the exponential ziggurat. */
+const double ZIGGURAT_EXPONENTIAL_V = 3.949659822581572e-3;
+
+/**
+ * Layer boundaries of the ziggurats. Layer i covers [0, x[i]]; the part
+ * below x[i + 1] lies entirely under the density, ratio[i] = x[i + 1] / x[i].
+ * Layer 0 is the base strip, whose area includes the tail beyond R = x[1].
+ */
+struct ZigguratTables
+{
+    double normalX[ZIGGURAT_NORMAL_LAYERS + 1];           //!< Normal layer widths
+    double normalRatio[ZIGGURAT_NORMAL_LAYERS];           //!< Normal fast acceptance ratios
+    double exponentialX[ZIGGURAT_EXPONENTIAL_LAYERS + 1]; //!< Exponential layer widths
+    double exponentialRatio[ZIGGURAT_EXPONENTIAL_LAYERS]; //!< Exponential fast acceptance ratios
+    double exponentialF[ZIGGURAT_EXPONENTIAL_LAYERS + 1]; //!< exp(-x) at the layer widths
+};
+
+/**
+ * Compute the ziggurat tables.
+ */
+ZigguratTables
+MakeZigguratTables()
+{
+    ZigguratTables t;
+
+    const double rn = ZIGGURAT_NORMAL_R;
+    t.normalX[0] = ZIGGURAT_NORMAL_V / std::exp(-0.5 * rn * rn);
+    t.normalX[1] = rn;
+    t.normalX[ZIGGURAT_NORMAL_LAYERS] = 0;
+    for (int i = 2; i < ZIGGURAT_NORMAL_LAYERS; ++i)
+    {
+        double x = t.normalX[i - 1];
+        t.normalX[i] = std::sqrt(-2 * std::log(ZIGGURAT_NORMAL_V / x + std::exp(-0.5 * x * x)));
+    }
+    for (int i = 0; i < ZIGGURAT_NORMAL_LAYERS; ++i)
+    {
+        t.normalRatio[i] = t.normalX[i + 1] / t.normalX[i];
+    }
+
+    const double re = ZIGGURAT_EXPONENTIAL_R;
+    t.exponentialX[0] = ZIGGURAT_EXPONENTIAL_V / std::exp(-re);
+    t.exponentialX[1] = re;
+    t.exponentialX[ZIGGURAT_EXPONENTIAL_LAYERS] = 0;
+    for (int i = 2; i < ZIGGURAT_EXPONENTIAL_LAYERS; ++i)
+    {
+        double x = t.exponentialX[i - 1];
+        t.exponentialX[i] = -std::log(ZIGGURAT_EXPONENTIAL_V / x + std::exp(-x));
+    }
+    for (int i = 0; i < ZIGGURAT_EXPONENTIAL_LAYERS; ++i)
+    {
+        t.exponentialRatio[i] = t.exponentialX[i + 1] / t.exponentialX[i];
+    }
+    for (int i = 0; i <= ZIGGURAT_EXPONENTIAL_LAYERS; ++i)
+    {
+        t.exponentialF[i] = std::exp(-t.exponentialX[i]);
+    }
+    return t;
+}
+
+/**
+ * Get the ziggurat tables, computed on first use.
+ */
+const ZigguratTables&
+GetZigguratTables()
+{
+    static const ZigguratTables tables = MakeZigguratTables();
+    return tables;
+}
+
+/**
+ * Get a uniform number in (0,1), antithetic if requested.
+ */
+double
+ZigguratUniform(RngEngine* rng, bool antithetic)
+{
+    double u = rng->RandU01();
+    return antithetic ? 1 - u : u;
+}
+
+/**
+ * Get 32 random bits out of a uniform number.
+ */
+uint32_t
+ZigguratBits(RngEngine* rng, bool antithetic)
+{
+    double scaled = ZigguratUniform(rng, antithetic) * 4294967296.0;
+    return scaled >= 4294967295.0 ? 0xffffffff : static_cast<uint32_t>(scaled);
+}
+
+/**
+ * Draw a standard normal value with the ziggurat method.
+ *
+ * The low 7 bits of a draw select the layer, the other 25 give a point in
+ * (-1, 1) across it.
+ */
+double
+ZigguratNormal(RngEngine* rng, bool antithetic)
+{
+    const ZigguratTables& t = GetZigguratTables();
+    while (true)
+    {
+        uint32_t bits = ZigguratBits(rng, antithetic);
+        int i = bits & (ZIGGURAT_NORMAL_LAYERS - 1);
+        double u = ((bits >> 7) + 0.5) * (2.0 / 33554432.0) - 1;
+        if (std::fabs(u) < t.normalRatio[i])
+        {
+            return u * t.normalX[i];
+        }
+        if (i == 0)
+        {
+            // Tail beyond R, Marsaglia's method
+            double x;
+            double y;
+            do
+            {
+                x = std::log(ZigguratUniform(rng, antithetic)) / ZIGGURAT_NORMAL_R;
+                y = std::log(ZigguratUniform(rng, antithetic));
+            } while (-2 * y < x * x);
+            return u < 0 ? x - ZIGGURAT_NORMAL_R : ZIGGURAT_NORMAL_R - x;
+        }
+        // Wedge between x[i + 1] and x[i]
+        double x = u * t.normalX[i];
+        double f0 = std::exp(-0.5 * (t.normalX[i] * t.normalX[i] - x * x));
+        double f1 = std::exp(-0.5 * (t.normalX[i + 1] * t.normalX[i + 1] - x * x));
+        if (f1 + ZigguratUniform(rng, antithetic) * (f0 - f1) < 1.0)
+        {
+            return x;
+        }
+    }
+}
+
+/**
+ * Draw a standard exponential value with the ziggurat method.
+ *
+ * The low 8 bits of a draw select the layer, the other 24 give a point in
+ * (0, 1) across it.
+ */
+double
+ZigguratExponential(RngEngine* rng, bool antithetic)
+{
+    const ZigguratTables& t = GetZigguratTables();
+    while (true)
+    {
+        uint32_t bits = ZigguratBits(rng, antithetic);
+        int i = bits & (ZIGGURAT_EXPONENTIAL_LAYERS - 1);
+        double u = ((bits >> 8) + 0.5) * (1.0 / 16777216.0);
+        if (u < t.exponentialRatio[i])
+        {
+            return u * t.exponentialX[i];
+        }
+        if (i == 0)
+        {
+            // The exponential tail beyond R is R plus an exponential
+            return ZIGGURAT_EXPONENTIAL_R - std::log(ZigguratUniform(rng, antithetic));
+        }
+        // Wedge between x[i + 1] and x[i]
+        double x = u * t.exponentialX[i];
+        double y = t.exponentialF[i] +
+                   ZigguratUniform(rng, antithetic) * (t.exponentialF[i + 1] - t.exponentialF[i]);
+        if (y < std::exp(-x))
+        {
+            return x;
+        }
+    }
+}
+
+/**
+ * The rejection loop of the Marsaglia-Tsang gamma method.
+ *
+ * \param rng The uniform number generator.
+ * \param antithetic Whether to use antithetic uniform numbers.
+ * \param d The constant alpha - 1/3.
+ * \param c The constant 1 / sqrt(9 d).
+ * \param normal Draws a standard normal value.
+ * \return v, the gamma value being d x v.
+ */
+template <class Normal>
+double
+MarsagliaTsang(RngEngine* rng, bool antithetic, double d, double c, Normal normal)
+{
+    double x;
+    double v;
+    double u;
+    while (1)
+    {
+        do
+        {
+            x = normal();
+            v = 1.0 + c * x;
+        } while (v <= 0);
+
+        v = v * v * v;
+        u = rng->RandU01();
+        if (antithetic)
+        {
+            u = (1 - u);
+        }
+        if (u < 1 - 0.0331 * x * x * x * x)
+        {
+            break;
+        }
+        if (std::log(u) < 0.5 * x * x + d * (1 - v + std::log(v)))
+        {
+            break;
+        }
+    }
+    return v;
+}
+
+} // namespace
+
 TypeId
 RandomVariableStream::GetTypeId()
 {
@@ -85,12 +348,6 @@ void RandomVariableStream::SetAntithetic(bool isAntithetic)
     m_isAntithetic = isAntithetic;
 }
 
-bool RandomVariableStream::IsAntithetic() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_isAntithetic;
-}
-
 void RandomVariableStream::SetStream(int64_t stream)
 {
     NS_LOG_FUNCTION(this << stream);
@@ -103,7 +360,18 @@ void RandomVariableStream::SetStream(int64_t stream)
         // number assignment.
         uint64_t nextStream = RngSeedManager::GetNextStreamIndex();
         NS_ASSERT(nextStream <= ((1ULL) << 63));
-        m_rng = new RngStream(RngSeedManager::GetSeed(), nextStream, RngSeedManager::GetRun());
+        if (RngSeedManager::GetEngine() == "MRG32k3a")
+        {
+            m_rng = CreateAutomaticStream(RngSeedManager::GetSeed(),
+                                          RngSeedManager::GetRun(),
+                                          nextStream);
+        }
+        else
+        {
+            m_rng = RngEngine::Create(RngSeedManager::GetSeed(),
+                                      nextStream,
+                                      RngSeedManager::GetRun());
+        }
     }
     else
     {
@@ -111,7 +379,7 @@ void RandomVariableStream::SetStream(int64_t stream)
         // number assignment.
         uint64_t base = ((1ULL) << 63);
         uint64_t target = base + stream;
-        m_rng = new RngStream(RngSeedManager::GetSeed(), target, RngSeedManager::GetRun());
+        m_rng = RngEngine::Create(RngSeedManager::GetSeed(), target, RngSeedManager::GetRun());
     }
     m_stream = stream;
 }
@@ -123,11 +391,14 @@ RandomVariableStream::GetStream() const
     return m_stream;
 }
 
-RngStream*
-RandomVariableStream::Peek() const
+void
+RandomVariableStream::GetValues(double* values, std::size_t count)
 {
-    NS_LOG_FUNCTION(this);
-    return m_rng;
+    NS_LOG_FUNCTION(this << values << count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        values[i] = GetValue();
+    }
 }
 
 NS_OBJECT_ENSURE_REGISTERED(UniformRandomVariable);
@@ -197,7 +468,7 @@ double
 UniformRandomVariable::GetValue()
 {
     NS_LOG_FUNCTION(this);
-    return GetValue(m_min, m_max);
+    return Sample();
 }
 
 uint32_t
@@ -207,6 +478,30 @@ UniformRandomVariable::GetInteger()
     return (uint32_t)GetValue(m_min, m_max + 1);
 }
 
+void
+UniformRandomVariable::GetValues(double* values, std::size_t count)
+{
+    NS_LOG_FUNCTION(this << values << count);
+    Peek()->Fill(values, count);
+    const double min = m_min;
+    const double range = m_max - m_min;
+    if (IsAntithetic())
+    {
+        const double max = m_max;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            values[i] = min + (max - (min + values[i] * range));
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            values[i] = min + values[i] * range;
+        }
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED(ConstantRandomVariable);
 
 TypeId
@@ -255,7 +550,7 @@ double
 ConstantRandomVariable::GetValue()
 {
     NS_LOG_FUNCTION(this);
-    return GetValue(m_constant);
+    return Sample();
 }
 
 uint32_t
@@ -388,7 +683,12 @@ ExponentialRandomVariable::GetTypeId()
                           "The upper bound on the values returned by this RNG stream.",
                           DoubleValue(0.0),
                           MakeDoubleAccessor(&ExponentialRandomVariable::m_bound),
-                          MakeDoubleChecker<double>());
+                          MakeDoubleChecker<double>())
+            .AddAttribute("Ziggurat",
+                          "Draw the values with the ziggurat method.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&ExponentialRandomVariable::m_ziggurat),
+                          MakeBooleanChecker());
     return tid;
 }
 
@@ -416,6 +716,17 @@ double
 ExponentialRandomVariable::GetValue(double mean, double bound)
 {
     NS_LOG_FUNCTION(this << mean << bound);
+    if (m_ziggurat)
+    {
+        while (1)
+        {
+            double r = mean * ZigguratExponential(Peek(), IsAntithetic());
+            if (bound == 0 || r <= bound)
+            {
+                return r;
+            }
+        }
+    }
     while (1)
     {
         // Get a uniform random variable in [0,1].
@@ -447,7 +758,20 @@ double
 ExponentialRandomVariable::GetValue()
 {
     NS_LOG_FUNCTION(this);
-    return GetValue(m_mean, m_bound);
+    return Sample();
+}
+
+double
+ExponentialRandomVariable::SampleZiggurat()
+{
+    while (1)
+    {
+        double r = m_mean * ZigguratExponential(Peek(), IsAntithetic());
+        if (m_bound == 0 || r <= m_bound)
+        {
+            return r;
+        }
+    }
 }
 
 uint32_t
@@ -457,6 +781,42 @@ ExponentialRandomVariable::GetInteger()
     return (uint32_t)GetValue(m_mean, m_bound);
 }
 
+void
+ExponentialRandomVariable::GetValues(double* values, std::size_t count)
+{
+    NS_LOG_FUNCTION(this << values << count);
+    if (m_ziggurat)
+    {
+        RandomVariableStream::GetValues(values, count);
+        return;
+    }
+    Peek()->Fill(values, count);
+    const double mean = m_mean;
+    const double bound = m_bound;
+    const bool antithetic = IsAntithetic();
+    // A rejected value consumes one more uniform, so the output can lag
+    // behind the uniforms; values[i] is only written once values[next] with
+    // next >= i has been read.
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        while (true)
+        {
+            double v = next < count ? values[next++] : Peek()->RandU01();
+            if (antithetic)
+            {
+                v = (1 - v);
+            }
+            double r = -mean * std::log(v);
+            if (bound == 0 || r <= bound)
+            {
+                values[i] = r;
+                break;
+            }
+        }
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED(ParetoRandomVariable);
 
 TypeId
@@ -553,7 +913,7 @@ double
 ParetoRandomVariable::GetValue()
 {
     NS_LOG_FUNCTION(this);
-    return GetValue(m_scale, m_shape, m_bound);
+    return Sample();
 }
 
 uint32_t
@@ -657,7 +1017,7 @@ double
 WeibullRandomVariable::GetValue()
 {
     NS_LOG_FUNCTION(this);
-    return GetValue(m_scale, m_shape, m_bound);
+    return Sample();
 }
 
 uint32_t
@@ -694,7 +1054,12 @@ NormalRandomVariable::GetTypeId()
                           "The bound on the values returned by this RNG stream.",
                           DoubleValue(INFINITE_VALUE),
                           MakeDoubleAccessor(&NormalRandomVariable::m_bound),
-                          MakeDoubleChecker<double>());
+                          MakeDoubleChecker<double>())
+            .AddAttribute("Ziggurat",
+                          "Draw the values with the ziggurat method.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NormalRandomVariable::m_ziggurat),
+                          MakeBooleanChecker());
     return tid;
 }
 
@@ -731,6 +1096,17 @@ double
 NormalRandomVariable::GetValue(double mean, double variance, double bound)
 {
     NS_LOG_FUNCTION(this << mean << variance << bound);
+    if (m_ziggurat)
+    {
+        while (1)
+        {
+            double x = mean + ZigguratNormal(Peek(), IsAntithetic()) * std::sqrt(variance);
+            if (std::fabs(x - mean) <= bound)
+            {
+                return x;
+            }
+        }
+    }
     if (m_nextValid)
     { // use previously generated
         m_nextValid = false;
@@ -820,7 +1196,12 @@ LogNormalRandomVariable::GetTypeId()
                 "The sigma value for the log-normal distribution returned by this RNG stream.",
                 DoubleValue(1.0),
                 MakeDoubleAccessor(&LogNormalRandomVariable::m_sigma),
-                MakeDoubleChecker<double>());
+                MakeDoubleChecker<double>())
+            .AddAttribute("Ziggurat",
+                          "Draw the underlying normal values with the ziggurat method.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&LogNormalRandomVariable::m_ziggurat),
+                          MakeBooleanChecker());
     return tid;
 }
 
@@ -882,6 +1263,11 @@ LogNormalRandomVariable::GetValue(double mu, double sigma)
 
     NS_LOG_FUNCTION(this << mu << sigma);
 
+    if (m_ziggurat)
+    {
+        return std::exp(sigma * ZigguratNormal(Peek(), IsAntithetic()) + mu);
+    }
+
     do
     {
         /* choose x,y in uniform square (-1,-1) to (+1,+1) */
@@ -948,12 +1334,20 @@ GammaRandomVariable::GetTypeId()
                           "The beta value for the gamma distribution returned by this RNG stream.",
                           DoubleValue(1.0),
                           MakeDoubleAccessor(&GammaRandomVariable::m_beta),
-                          MakeDoubleChecker<double>());
+                          MakeDoubleChecker<double>())
+            .AddAttribute("Ziggurat",
+                          "Draw the underlying normal values with the ziggurat method.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&GammaRandomVariable::m_ziggurat),
+                          MakeBooleanChecker());
     return tid;
 }
 
 GammaRandomVariable::GammaRandomVariable()
-    : m_nextValid(false)
+    : m_nextValid(false),
+      m_preparedAlpha(0.0),
+      m_d(0.0),
+      m_c(0.0)
 {
     // m_alpha and m_beta are initialized after constructor by
     // attributes
@@ -990,57 +1384,48 @@ GammaRandomVariable::GetBeta() const
 
   for x > 0.
 */
+void
+GammaRandomVariable::Prepare(double alpha)
+{
+    if (alpha == m_preparedAlpha)
+    {
+        return;
+    }
+    // Below 1, draw for alpha + 1 and scale by u^(1 / alpha)
+    double shape = (alpha < 1) ? 1.0 + alpha : alpha;
+    m_d = shape - 1.0 / 3.0;
+    m_c = (1.0 / 3.0) / std::sqrt(m_d);
+    m_preparedAlpha = alpha;
+}
+
 double
 GammaRandomVariable::GetValue(double alpha, double beta)
 {
     NS_LOG_FUNCTION(this << alpha << beta);
+    Prepare(alpha);
+
+    double u = 0;
     if (alpha < 1)
     {
-        double u = Peek()->RandU01();
+        u = Peek()->RandU01();
         if (IsAntithetic())
         {
             u = (1 - u);
         }
-        return GetValue(1.0 + alpha, beta) * std::pow(u, 1.0 / alpha);
     }
 
-    double x;
-    double v;
-    double u;
-    double d = alpha - 1.0 / 3.0;
-    double c = (1.0 / 3.0) / std::sqrt(d);
+    // Get values from a normal distribution that has mean zero,
+    // variance 1, and no bound.
+    double v = MarsagliaTsang(Peek(), IsAntithetic(), m_d, m_c, [this]() {
+        return GetNormalValue(0.0, 1.0, NormalRandomVariable::INFINITE_VALUE);
+    });
 
-    while (1)
+    double value = beta * m_d * v;
+    if (alpha < 1)
     {
-        do
-        {
-            // Get a value from a normal distribution that has mean
-            // zero, variance 1, and no bound.
-            double mean = 0.0;
-            double variance = 1.0;
-            double bound = NormalRandomVariable::INFINITE_VALUE;
-            x = GetNormalValue(mean, variance, bound);
-
-            v = 1.0 + c * x;
-        } while (v <= 0);
-
-        v = v * v * v;
-        u = Peek()->RandU01();
-        if (IsAntithetic())
-        {
-            u = (1 - u);
-        }
-        if (u < 1 - 0.0331 * x * x * x * x)
-        {
-            break;
-        }
-        if (std::log(u) < 0.5 * x * x + d * (1 - v + std::log(v)))
-        {
-            break;
-        }
+        value *= std::pow(u, 1.0 / alpha);
     }
-
-    return beta * d * v;
+    return value;
 }
 
 uint32_t
@@ -1068,6 +1453,17 @@ double
 GammaRandomVariable::GetNormalValue(double mean, double variance, double bound)
 {
     NS_LOG_FUNCTION(this << mean << variance << bound);
+    if (m_ziggurat)
+    {
+        while (1)
+        {
+            double x = mean + ZigguratNormal(Peek(), IsAntithetic()) * std::sqrt(variance);
+            if (std::fabs(x - mean) <= bound)
+            {
+                return x;
+            }
+        }
+    }
     if (m_nextValid)
     { // use previously generated
         m_nextValid = false;
@@ -1140,6 +1536,9 @@ ErlangRandomVariable::GetTypeId()
 }
 
 ErlangRandomVariable::ErlangRandomVariable()
+    : m_preparedK(0),
+      m_d(0.0),
+      m_c(0.0)
 {
     // m_k and m_lambda are initialized after constructor by attributes
     NS_LOG_FUNCTION(this);
@@ -1171,20 +1570,46 @@ ErlangRandomVariable::GetLambda() const
 
   for x > 0.
 */
+void
+ErlangRandomVariable::Prepare(uint32_t k)
+{
+    if (k == m_preparedK)
+    {
+        return;
+    }
+    m_d = k - 1.0 / 3.0;
+    m_c = (1.0 / 3.0) / std::sqrt(m_d);
+    m_preparedK = k;
+}
+
 double
 ErlangRandomVariable::GetValue(uint32_t k, double lambda)
 {
     NS_LOG_FUNCTION(this << k << lambda);
-    double mean = lambda;
-    double bound = 0.0;
 
-    double result = 0;
-    for (unsigned int i = 0; i < k; ++i)
+    if (k > ERLANG_PRODUCT_MAX_K)
     {
-        result += GetExponentialValue(mean, bound);
+        Prepare(k);
+        double v = MarsagliaTsang(Peek(), IsAntithetic(), m_d, m_c, [this]() {
+            return ZigguratNormal(Peek(), IsAntithetic());
+        });
+        return lambda * m_d * v;
     }
 
-    return result;
+    // The sum of k exponential values is -lambda x log of the product
+    // of their uniform numbers. Uniform numbers are at least 2^-53, so the
+    // product of 16 of them cannot underflow.
+    double product = 1.0;
+    for (uint32_t i = 0; i < k; ++i)
+    {
+        double u = Peek()->RandU01();
+        if (IsAntithetic())
+        {
+            u = (1 - u);
+        }
+        product *= u;
+    }
+    return -lambda * std::log(product);
 }
 
 uint32_t
@@ -1208,30 +1633,6 @@ ErlangRandomVariable::GetInteger()
     return (uint32_t)GetValue(m_k, m_lambda);
 }
 
-double
-ErlangRandomVariable::GetExponentialValue(double mean, double bound)
-{
-    NS_LOG_FUNCTION(this << mean << bound);
-    while (1)
-    {
-        // Get a uniform random variable in [0,1].
-        double v = Peek()->RandU01();
-        if (IsAntithetic())
-        {
-            v = (1 - v);
-        }
-
-        // Calculate the exponential random variable.
-        double r = -mean * std::log(v);
-
-        // Use this value if it's acceptable.
-        if (bound == 0 || r <= bound)
-        {
-            return r;
-        }
-    }
-}
-
 NS_OBJECT_ENSURE_REGISTERED(TriangularRandomVariable);
 
 TypeId
@@ -1325,7 +1726,7 @@ double
 TriangularRandomVariable::GetValue()
 {
     NS_LOG_FUNCTION(this);
-    return GetValue(m_mean, m_min, m_max);
+    return Sample();
 }
 
 uint32_t
@@ -1359,11 +1760,96 @@ ZipfRandomVariable::GetTypeId()
 }
 
 ZipfRandomVariable::ZipfRandomVariable()
+    : m_preparedN(0),
+      m_preparedAlpha(0.0),
+      m_hIntegralX1(0.0),
+      m_hIntegralN(0.0),
+      m_s(0.0)
 {
     // m_n and m_alpha are initialized after constructor by attributes
     NS_LOG_FUNCTION(this);
 }
 
+namespace
+{
+
+/**
+ * log(1 + x) / x, accurate near 0.
+ */
+double
+ZipfHelper1(double x)
+{
+    if (std::abs(x) > 1e-8)
+    {
+        return std::log1p(x) / x;
+    }
+    return 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+}
+
+/**
+ * (exp(x) - 1) / x, accurate near 0.
+ */
+double
+ZipfHelper2(double x)
+{
+    if (std::abs(x) > 1e-8)
+    {
+        return std::expm1(x) / x;
+    }
+    return 1 + x * 0.5 * (1 + x * (1.0 / 3) * (1 + 0.25 * x));
+}
+
+/**
+ * The hat function h(x) = x^-alpha.
+ */
+double
+ZipfH(double x, double alpha)
+{
+    return std::exp(-alpha * std::log(x));
+}
+
+/**
+ * H(x), the integral of h from 1 to x.
+ */
+double
+ZipfHIntegral(double x, double alpha)
+{
+    double logX = std::log(x);
+    return ZipfHelper2((1 - alpha) * logX) * logX;
+}
+
+/**
+ * The inverse of H.
+ */
+double
+ZipfHIntegralInverse(double x, double alpha)
+{
+    double t = x * (1 - alpha);
+    if (t < -1)
+    {
+        // Limit the value to the domain of log1p, rounding can go below
+        t = -1;
+    }
+    return std::exp(ZipfHelper1(t) * x);
+}
+
+} // namespace
+
+void
+ZipfRandomVariable::Prepare(uint32_t n, double alpha)
+{
+    if (n == m_preparedN && alpha == m_preparedAlpha)
+    {
+        return;
+    }
+    NS_ABORT_MSG_IF(alpha < 0, "Zipf alpha must not be negative, got " << alpha);
+    m_hIntegralX1 = ZipfHIntegral(1.5, alpha) - 1;
+    m_hIntegralN = ZipfHIntegral(n + 0.5, alpha);
+    m_s = 2 - ZipfHIntegralInverse(ZipfHIntegral(2.5, alpha) - ZipfH(2, alpha), alpha);
+    m_preparedN = n;
+    m_preparedAlpha = alpha;
+}
+
 uint32_t
 ZipfRandomVariable::GetN() const
 {
@@ -1382,33 +1868,40 @@ double
 ZipfRandomVariable::GetValue(uint32_t n, double alpha)
 {
     NS_LOG_FUNCTION(this << n << alpha);
-    // Calculate the normalization constant c.
-    m_c = 0.0;
-    for (uint32_t i = 1; i <= n; i++)
+    if (n == 0)
     {
-        m_c += (1.0 / std::pow((double)i, alpha));
+        return 0;
     }
-    m_c = 1.0 / m_c;
+    Prepare(n, alpha);
 
-    // Get a uniform random variable in [0,1].
-    double u = Peek()->RandU01();
-    if (IsAntithetic())
+    while (1)
     {
-        u = (1 - u);
-    }
+        // Get a uniform random variable in [0,1].
+        double v = Peek()->RandU01();
+        if (IsAntithetic())
+        {
+            v = (1 - v);
+        }
 
-    double sum_prob = 0;
-    double zipf_value = 0;
-    for (uint32_t i = 1; i <= m_n; i++)
-    {
-        sum_prob += m_c / std::pow((double)i, m_alpha);
-        if (sum_prob > u)
+        // Invert the integral of the hat function at a uniform point
+        double u = m_hIntegralN + v * (m_hIntegralX1 - m_hIntegralN);
+        double x = ZipfHIntegralInverse(u, alpha);
+        double k = std::floor(x + 0.5);
+        if (k < 1)
         {
-            zipf_value = i;
-            break;
+            k = 1;
+        }
+        else if (k > n)
+        {
+            k = n;
+        }
+
+        // Accept k unless u falls in the part of the hat above h(k)
+        if (k - x <= m_s || u >= ZipfHIntegral(k + 0.5, alpha) - ZipfH(k, alpha))
+        {
+            return k;
         }
     }
-    return zipf_value;
 }
 
 uint32_t
@@ -1630,6 +2123,12 @@ EmpiricalRandomVariable::GetTypeId()
                           "default is to treat the CDF as a histogram and sample.",
                           BooleanValue(false),
                           MakeBooleanAccessor(&EmpiricalRandomVariable::m_interpolate),
+                          MakeBooleanChecker())
+            .AddAttribute("Alias",
+                          "Sample from an alias table in constant time, "
+                          "instead of searching the CDF.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&EmpiricalRandomVariable::m_alias),
                           MakeBooleanChecker());
     return tid;
 }
@@ -1693,6 +2192,11 @@ double EmpiricalRandomVariable::GetValue()
 {
     NS_LOG_FUNCTION(this);
 
+    if (m_alias)
+    {
+        return DoSampleAlias(m_interpolate);
+    }
+
     double value;
     if (PreSample(value))
     {
@@ -1725,6 +2229,11 @@ double EmpiricalRandomVariable::Interpolate()
 {
     NS_LOG_FUNCTION(this);
 
+    if (m_alias)
+    {
+        return DoSampleAlias(true);
+    }
+
     double value;
     if (PreSample(value))
     {
@@ -1762,12 +2271,63 @@ double EmpiricalRandomVariable::DoInterpolate(double r)
     return value;
 }
 
+double EmpiricalRandomVariable::DoSampleAlias(bool interpolate)
+{
+    NS_LOG_FUNCTION(this << interpolate);
+
+    if (!m_validated)
+    {
+        Validate();
+    }
+
+    // Get a uniform random variable in [0, 1].
+    double r = Peek()->RandU01();
+    if (IsAntithetic())
+    {
+        r = (1 - r);
+    }
+
+    // The integer part of r x n selects a column, the fractional part
+    // decides between the column and its alias, and what is left of it
+    // is uniform over the selected bin.
+    const uint32_t n = m_aliasProb.size();
+    double x = r * n;
+    uint32_t column = static_cast<uint32_t>(x);
+    if (column >= n)
+    {
+        column = n - 1;
+    }
+    double f = x - column;
+    double keep = m_aliasProb[column];
+    uint32_t point;
+    double position;
+    if (f < keep)
+    {
+        point = column;
+        position = f / keep;
+    }
+    else
+    {
+        point = m_aliasIndex[column];
+        position = (f - keep) / (1 - keep);
+    }
+
+    if (!interpolate || point == 0)
+    {
+        return m_emp[point].value;
+    }
+    double v1 = m_emp[point - 1].value;
+    double v2 = m_emp[point].value;
+    return v1 + (v2 - v1) * position;
+}
+
 void EmpiricalRandomVariable::CDF(double v, double c)
 {
     // Add a new empirical datapoint to the empirical cdf
     // NOTE.   These MUST be inserted in non-decreasing order
     NS_LOG_FUNCTION(this << v << c);
     m_emp.emplace_back(v, c);
+    m_validated = false;
 }
 
 void EmpiricalRandomVariable::Validate()
@@ -1793,8 +2353,56 @@ void EmpiricalRandomVariable::Validate()
     {
         NS_FATAL_ERROR("CDF does not cover the whole distribution");
     }
+    BuildAliasTable();
     m_validated = true;
 }
 
+void EmpiricalRandomVariable::BuildAliasTable()
+{
+    NS_LOG_FUNCTION(this);
+
+    // Vose's algorithm: columns with less than the average probability are
+    // topped up by a column with more, until every column holds exactly
+    // the average.
+    const uint32_t n = m_emp.size();
+    std::vector<double> scaled(n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        double p = (i == 0) ? m_emp[0].cdf : m_emp[i].cdf - m_emp[i - 1].cdf;
+        scaled[i] = p * n;
+    }
+    m_aliasProb.assign(n, 1.0);
+    m_aliasIndex.resize(n);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        m_aliasIndex[i] = i;
+        if (scaled[i] < 1.0)
+        {
+            small.push_back(i);
+        }
+        else
+        {
+            large.push_back(i);
+        }
+    }
+    while (!small.empty() && !large.empty())
+    {
+        uint32_t less = small.back();
+        small.pop_back();
+        uint32_t more = large.back();
+        m_aliasProb[less] = scaled[less];
+        m_aliasIndex[less] = more;
+        scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+        if (scaled[more] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // What is left is 1 up to rounding errors: keep those columns
+}
+
 }
 
@@ -24,8 +24,11 @@
 
 #include "attribute-helper.h"
 #include "object.h"
+#include "rng-engine.h"
 #include "type-id.h"
 
+#include <cmath>
+#include <cstddef>
 #include <stdint.h>
 
 
@@ -56,11 +59,10 @@ namespace nsim2023
  *   section on how to perform independent replications.
  */
 
-class RngStream;
-
 /**
  * The underlying random number generation method used by ns-3 is the RngStream 
- * code by Pierre L'Ecuyer at the University of Montreal.
+ * code by Pierre L'Ecuyer at the University of Montreal. The counter-based
+ * PhiloxStream can be used instead through the "RngEngine" GlobalValue.
  */
 class RandomVariableStream : public Object
 {
@@ -81,7 +83,7 @@ class RandomVariableStream : public Object
 
     void SetAntithetic(bool isAntithetic);
 
-    bool IsAntithetic() const;
+    inline bool IsAntithetic() const;
 
     /**
      * Get the next random value as a double drawn from the distribution.
@@ -93,15 +95,22 @@ class RandomVariableStream : public Object
      */
     virtual uint32_t GetInteger() = 0;
 
+    /**
+     * Fill \p values with the next \p count random values drawn from the
+     * distribution, in the order \p count calls of GetValue() would
+     * return them.
+     */
+    virtual void GetValues(double* values, std::size_t count);
+
   protected:
     /**
-     * Get the pointer to the underlying RngStream.
+     * Get the pointer to the underlying RngEngine.
      */
-    RngStream* Peek() const;
+    inline RngEngine* Peek() const;
 
   private:
-    /** Pointer to the underlying RngStream. */
-    RngStream* m_rng;
+    /** Pointer to the underlying RngEngine. */
+    RngEngine* m_rng;
 
     /** Indicates if antithetic values should be generated by this RNG stream. */
     bool m_isAntithetic;
@@ -134,6 +143,15 @@ class UniformRandomVariable : public RandomVariableStream
 
     uint32_t GetInteger() override;
 
+    void GetValues(double* values, std::size_t count) override;
+
+    /**
+     * Get the next random value, like GetValue(), but without logging and
+     * inline: a model holding a Ptr<UniformRandomVariable> pays no virtual
+     * call or log check besides the one of the RngEngine.
+     */
+    inline double Sample();
+
   private:
     /** The lower bound on values that can be returned by this RNG stream. */
     double m_min;
@@ -161,6 +179,9 @@ class ConstantRandomVariable : public RandomVariableStream
 
     uint32_t GetInteger() override;
 
+    /** Get the constant, like GetValue(), inline and without logging. */
+    inline double Sample();
+
   private:
     /** The constant value returned by this RNG stream. */
     double m_constant;
@@ -226,6 +247,9 @@ class SequentialRandomVariable : public RandomVariableStream
  * This class supports the creation of objects that return random numbers
  * from a fixed exponential distribution.  It also supports the generation of
  * single random numbers from various exponential distributions.
+ *
+ * With the \c Ziggurat Attribute set, values are drawn with the ziggurat
+ * method instead of -log(u), see NormalRandomVariable.
  */
 class ExponentialRandomVariable : public RandomVariableStream
 {
@@ -250,14 +274,24 @@ class ExponentialRandomVariable : public RandomVariableStream
     // Inherited from RandomVariableStream
     double GetValue() override;
     uint32_t GetInteger() override;
+    void GetValues(double* values, std::size_t count) override;
+
+    /** Get the next random value, like GetValue(), inline and without logging. */
+    inline double Sample();
 
   private:
+    /** The ziggurat path of Sample(), out of line. */
+    double SampleZiggurat();
+
     /** The mean value of the unbounded exponential distribution. */
     double m_mean;
 
     /** The upper bound on values that can be returned by this RNG stream. */
     double m_bound;
 
+    /** Draw with the ziggurat method instead of -log(u). */
+    bool m_ziggurat;
+
 }; // class ExponentialRandomVariable
 
 
@@ -287,6 +321,9 @@ class ParetoRandomVariable : public RandomVariableStream
 
     uint32_t GetInteger() override;
 
+    /** Get the next random value, like GetValue(), inline and without logging. */
+    inline double Sample();
+
   private:
     /** The scale parameter for the Pareto distribution returned by this RNG stream. */
     double m_scale;
@@ -444,6 +481,9 @@ class WeibullRandomVariable : public RandomVariableStream
      */
     uint32_t GetInteger() override;
 
+    /** Get the next random value, like GetValue(), inline and without logging. */
+    inline double Sample();
+
   private:
     /** The scale parameter for the Weibull distribution returned by this RNG stream. */
     double m_scale;
@@ -475,6 +515,14 @@ class WeibullRandomVariable : public RandomVariableStream
  * this bound, i.e. its values are confined to the interval
  * [\f$mean-bound\f$,\f$mean+bound\f$].
  *
+ * Values are drawn with the polar Box-Muller method by default. With the
+ * \c Ziggurat Attribute set, they are drawn with the ziggurat method of
+ * G. Marsaglia and W. W. Tsang, "The ziggurat method for generating random
+ * variables", Journal of Statistical Software 5(8), 2000, as improved by
+ * J. A. Doornik. Most values then take a single uniform number, one table
+ * lookup and one multiplication, with no sqrt() nor log(). Antithetic
+ * uniforms are used as usual, but the values are not monotone in them.
+ *
  * Here is an example of how to use this class:
  * \code
  *   double mean = 5.0;
@@ -704,6 +752,9 @@ class NormalRandomVariable : public RandomVariableStream
     /** The algorithm produces two values at a time. Cache parameters for possible reuse.*/
     double m_y;
 
+    /** Draw with the ziggurat method instead of Box-Muller. */
+    bool m_ziggurat;
+
 }; // class NormalRandomVariable
 
 /**
@@ -748,6 +799,9 @@ class NormalRandomVariable : public RandomVariableStream
  *   //
  *   double value = x->GetValue ();
  * \endcode
+ *
+ * With the \c Ziggurat Attribute set, the underlying normal values are
+ * drawn with the ziggurat method, see NormalRandomVariable.
  */
 class LogNormalRandomVariable : public RandomVariableStream
 {
@@ -931,6 +985,9 @@ class LogNormalRandomVariable : public RandomVariableStream
     /** The sigma value for the log-normal distribution returned by this RNG stream. */
     double m_sigma;
 
+    /** Draw the normal values with the ziggurat method instead of Box-Muller. */
+    bool m_ziggurat;
+
 }; // class LogNormalRandomVariable
 
 /**
@@ -963,6 +1020,9 @@ class LogNormalRandomVariable : public RandomVariableStream
  *   //
  *   double value = x->GetValue ();
  * \endcode
+ *
+ * With the \c Ziggurat Attribute set, the underlying normal values are
+ * drawn with the ziggurat method, see NormalRandomVariable.
  */
 class GammaRandomVariable : public RandomVariableStream
 {
@@ -1109,6 +1169,25 @@ class GammaRandomVariable : public RandomVariableStream
     /** The algorithm produces two values at a time. Cache parameters for possible reuse.*/
     double m_y;
 
+    /** Draw the normal values with the ziggurat method instead of Box-Muller. */
+    bool m_ziggurat;
+
+    /**
+     * \brief Compute the constants of the Marsaglia-Tsang method for
+     * \p alpha, unless they are the ones already computed.
+     * \param [in] alpha Alpha value for the gamma distribution.
+     */
+    void Prepare(double alpha);
+
+    /** The alpha value the constants were computed for, 0 if none. */
+    double m_preparedAlpha;
+
+    /** Marsaglia-Tsang: d = alpha - 1/3, with alpha raised by 1 when below 1. */
+    double m_d;
+
+    /** Marsaglia-Tsang: c = 1 / sqrt(9 d). */
+    double m_c;
+
 }; // class GammaRandomVariable
 
 /**
@@ -1124,6 +1203,11 @@ class GammaRandomVariable : public RandomVariableStream
  * (= alpha) is a non-negative integer. Erlang distributed variables can be
  * generated using a much faster algorithm than gamma variables.
  *
+ * Up to ERLANG_PRODUCT_MAX_K, a value is -lambda times the log of the
+ * product of k uniform numbers, which takes a single log() call. Above, it
+ * is drawn as a gamma variable with the Marsaglia-Tsang method, in
+ * constant time whatever k.
+ *
  * The probability density function is defined over the interval [0,\f$+\infty\f$) as:
  * \f$ \frac{x^{k-1} e^{-\frac{x}{\lambda}}}{\lambda^k (k-1)!}\f$
  * where \f$ mean = k \lambda \f$ and
@@ -1149,6 +1233,9 @@ class GammaRandomVariable : public RandomVariableStream
 class ErlangRandomVariable : public RandomVariableStream
 {
   public:
+    /** Largest k for which values are drawn as a product of uniforms. */
+    static const uint32_t ERLANG_PRODUCT_MAX_K = 16;
+
     /**
      * \brief Register this type.
      * \return The object TypeId.
@@ -1238,31 +1325,11 @@ class ErlangRandomVariable : public RandomVariableStream
 
   private:
     /**
-     * \brief Returns a random double from an exponential distribution with the specified mean and
-     * upper bound.
-     * \param [in] mean Mean value of the random variables.
-     * \param [in] bound Upper bound on values returned.
-     * \return A floating point random value.
-     *
-     * Note that antithetic values are being generated if
-     * m_isAntithetic is equal to true.  If \f$u\f$ is a uniform variable
-     * over [0,1] and
-     *
-     *    \f[
-     *         x = - mean * \log(u)
-     *    \f]
-     *
-     * is a value that would be returned normally, then \f$(1 - u\f$) is
-     * the distance that \f$u\f$ would be from \f$1\f$.  The value
-     * returned in the antithetic case, \f$x'\f$, is calculated as
-     *
-     *    \f[
-     *         x' = - mean * \log(1 - u),
-     *    \f]
-     *
-     * which now involves the log of the distance \f$u\f$ is from the 1.
+     * \brief Compute the constants of the Marsaglia-Tsang method for
+     * \p k, unless they are the ones already computed.
+     * \param [in] k K value for the Erlang distribution.
      */
-    double GetExponentialValue(double mean, double bound);
+    void Prepare(uint32_t k);
 
     /** The k value for the Erlang distribution returned by this RNG stream. */
     uint32_t m_k;
@@ -1270,6 +1337,15 @@ class ErlangRandomVariable : public RandomVariableStream
     /** The lambda value for the Erlang distribution returned by this RNG stream. */
     double m_lambda;
 
+    /** The k value the constants were computed for, 0 if none. */
+    uint32_t m_preparedK;
+
+    /** Marsaglia-Tsang: d = k - 1/3. */
+    double m_d;
+
+    /** Marsaglia-Tsang: c = 1 / sqrt(9 d). */
+    double m_c;
+
 }; // class ErlangRandomVariable
 
 /**
@@ -1492,6 +1568,9 @@ class TriangularRandomVariable : public RandomVariableStream
      */
     uint32_t GetInteger() override;
 
+    /** Get the next random value, like GetValue(), inline and without logging. */
+    inline double Sample();
+
   private:
     /** The mean value for the triangular distribution returned by this RNG stream. */
     double m_mean;
@@ -1522,6 +1601,12 @@ class TriangularRandomVariable : public RandomVariableStream
  * Probability Mass Function is \f$ f(k; \alpha, N) = k^{-\alpha}/ H_{N,\alpha} \f$
  * where \f$ H_{N,\alpha} = \sum_{m=1}^N m^{-\alpha} \f$
  *
+ * Values are drawn in constant expected time, whatever N, with the
+ * rejection-inversion method of W. Hormann and G. Derflinger, "Rejection-
+ * inversion to generate variates from monotone discrete distributions",
+ * ACM TOMACS 6(3), 1996. The constants of the method are computed once
+ * per (N, alpha).
+ *
  * Here is an example of how to use this class:
  * \code
  *   uint32_t n = 1;
@@ -1659,8 +1744,26 @@ class ZipfRandomVariable : public RandomVariableStream
     /** The alpha value for the Zipf distribution returned by this RNG stream. */
     double m_alpha;
 
-    /** The normalization constant. */
-    double m_c;
+    /**
+     * Compute the sampler constants for \p n and \p alpha, unless they
+     * are the ones already computed.
+     */
+    void Prepare(uint32_t n, double alpha);
+
+    /** The n value the sampler constants were computed for, 0 if none. */
+    uint32_t m_preparedN;
+
+    /** The alpha value the sampler constants were computed for. */
+    double m_preparedAlpha;
+
+    /** Rejection-inversion: H(1.5) - 1, upper end of the sampled interval. */
+    double m_hIntegralX1;
+
+    /** Rejection-inversion: H(n + 0.5), lower end of the sampled interval. */
+    double m_hIntegralN;
+
+    /** Rejection-inversion: values this close to their rank are always accepted. */
+    double m_s;
 
 }; // class ZipfRandomVariable
 
@@ -1947,6 +2050,14 @@ class DeterministicRandomVariable : public RandomVariableStream
  *
  * This will return continuous values on the range [0,1).
  *
+ * Both modes search the CDF for each value, in O(log n) time for a CDF
+ * of n points. With the \c Alias Attribute set, values are drawn from an
+ * alias table (Walker's method, built with Vose's algorithm) instead, in
+ * constant time. The table is built once, when the CDF is validated, and
+ * each value still uses a single uniform number. The distribution is the
+ * same, but the mapping from the uniform number to the value is not
+ * monotone, so antithetic values are no longer negatively correlated.
+ *
  * See empirical-random-variable-example.cc for an example.
  */
 class EmpiricalRandomVariable : public RandomVariableStream
@@ -2080,6 +2191,16 @@ class EmpiricalRandomVariable : public RandomVariableStream
      * \returns The interpolated CDF at \pname{r}
      */
     double DoInterpolate(double r);
+    /**
+     * \brief Build the alias table from the validated CDF.
+     */
+    void BuildAliasTable();
+    /**
+     * \brief Draw a value from the alias table.
+     * \param [in] interpolate If \c true interpolate within the selected bin.
+     * \return The sampled or interpolated value.
+     */
+    double DoSampleAlias(bool interpolate);
 
     /**
      * \brief Comparison operator, for use by std::upper_bound
@@ -2098,9 +2219,130 @@ class EmpiricalRandomVariable : public RandomVariableStream
      * otherwise treat CDF as normal histogram.
      */
     bool m_interpolate;
+    /** If \c true sample from the alias table instead of searching the CDF. */
+    bool m_alias;
+    /**
+     * Alias table: probability of keeping column i, given that column i
+     * was drawn. Point 0 stands for the probability of the first CDF point
+     * and point i > 0 for the bin between points i - 1 and i.
+     */
+    std::vector<double> m_aliasProb;
+    /** Alias table: point selected when column i is not kept. */
+    std::vector<uint32_t> m_aliasIndex;
 
 }; // class EmpiricalRandomVariable
 
+/*************************************************
+ *  Inline implementations
+ ************************************************/
+
+RngEngine*
+RandomVariableStream::Peek() const
+{
+    return m_rng;
+}
+
+bool
+RandomVariableStream::IsAntithetic() const
+{
+    return m_isAntithetic;
+}
+
+double
+UniformRandomVariable::Sample()
+{
+    double v = m_min + Peek()->RandU01() * (m_max - m_min);
+    if (IsAntithetic())
+    {
+        v = m_min + (m_max - v);
+    }
+    return v;
+}
+
+double
+ConstantRandomVariable::Sample()
+{
+    return m_constant;
+}
+
+double
+ExponentialRandomVariable::Sample()
+{
+    if (m_ziggurat)
+    {
+        return SampleZiggurat();
+    }
+    while (1)
+    {
+        double v = Peek()->RandU01();
+        if (IsAntithetic())
+        {
+            v = (1 - v);
+        }
+        double r = -m_mean * std::log(v);
+        if (m_bound == 0 || r <= m_bound)
+        {
+            return r;
+        }
+    }
+}
+
+double
+ParetoRandomVariable::Sample()
+{
+    while (1)
+    {
+        double v = Peek()->RandU01();
+        if (IsAntithetic())
+        {
+            v = (1 - v);
+        }
+        double r = (m_scale * (1.0 / std::pow(v, 1.0 / m_shape)));
+        if (m_bound == 0 || r <= m_bound)
+        {
+            return r;
+        }
+    }
+}
+
+double
+WeibullRandomVariable::Sample()
+{
+    double exponent = 1.0 / m_shape;
+    while (1)
+    {
+        double v = Peek()->RandU01();
+        if (IsAntithetic())
+        {
+            v = (1 - v);
+        }
+        double r = m_scale * std::pow(-std::log(v), exponent);
+        if (m_bound == 0 || r <= m_bound)
+        {
+            return r;
+        }
+    }
+}
+
+double
+TriangularRandomVariable::Sample()
+{
+    double mode = 3.0 * m_mean - m_min - m_max;
+    double u = Peek()->RandU01();
+    if (IsAntithetic())
+    {
+        u = (1 - u);
+    }
+    if (u <= (mode - m_min) / (m_max - m_min))
+    {
+        return m_min + std::sqrt(u * (m_max - m_min) * (mode - m_min));
+    }
+    else
+    {
+        return m_max - std::sqrt((1 - u) * (m_max - m_min) * (m_max - mode));
+    }
+}
+
 }
 
 #endif /* RANDOM_VARIABLE_STREAM_H */
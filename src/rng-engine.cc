@@ -0,0 +1,68 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#include "rng-engine.h"
+
+#include "fatal-error.h"
+#include "log.h"
+#include "philox-stream.h"
+#include "rng-seed-manager.h"
+#include "rng-stream.h"
+
+#include <string>
+
+
+namespace nsim2023
+{
+
+NS_LOG_COMPONENT_DEFINE("RngEngine");
+
+RngEngine::~RngEngine()
+{
+}
+
+void
+RngEngine::Fill(double* values, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        values[i] = RandU01();
+    }
+}
+
+RngEngine*
+RngEngine::Create(uint32_t seed, uint64_t stream, uint64_t substream)
+{
+    NS_LOG_FUNCTION(seed << stream << substream);
+    std::string engine = RngSeedManager::GetEngine();
+    if (engine == "MRG32k3a")
+    {
+        return new RngStream(seed, stream, substream);
+    }
+    if (engine == "Philox4x32")
+    {
+        return new PhiloxStream(seed, stream, substream);
+    }
+    NS_FATAL_ERROR("unknown RngEngine \"" << engine << "\", expected MRG32k3a or Philox4x32");
+    return nullptr;
+}
+
+}
@@ -0,0 +1,66 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#ifndef RNG_ENGINE_H
+#define RNG_ENGINE_H
+
+#include <cstddef>
+#include <stdint.h>
+
+
+namespace nsim2023
+{
+
+/**
+ * Source of the uniform numbers of a RandomVariableStream.
+ *
+ * The engine used for new streams is selected with the "RngEngine"
+ * GlobalValue:
+ * - "MRG32k3a": the RngStream combined multiple-recursive generator.
+ * - "Philox4x32": the PhiloxStream counter-based generator.
+ */
+class RngEngine
+{
+  public:
+    virtual ~RngEngine();
+
+    /**
+     * Generate the next random number of this engine.
+     * Uniformly distributed between 0 and 1.
+     */
+    virtual double RandU01() = 0;
+
+    /**
+     * Fill \p values with the next \p count numbers of this engine, in the
+     * order \p count calls of RandU01() would return them.
+     */
+    virtual void Fill(double* values, std::size_t count);
+
+    /**
+     * Create the engine selected by the "RngEngine" GlobalValue for
+     * \p stream of \p substream.
+     */
+    static RngEngine* Create(uint32_t seed, uint64_t stream, uint64_t substream);
+};
+
+}
+
+#endif /* RNG_ENGINE_H */
@@ -21,12 +21,19 @@
 
 #include "rng-seed-manager.h"
 
+#include "abort.h"
 #include "attribute-helper.h"
 #include "config.h"
 #include "global-value.h"
 #include "log.h"
+#include "nsim-string.h"
 #include "uinteger.h"
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+
 
 namespace nsim2023
 {
@@ -37,7 +44,12 @@ NS_LOG_COMPONENT_DEFINE("RngSeedManager");
  * The next random number generator stream number to use
  * for automatic assignment.
  */
-static uint64_t g_nextStreamIndex = 0;
+static std::atomic<uint64_t> g_nextStreamIndex(0);
+
+/** Number of stream indices in the shared range and in each partition. */
+static const uint64_t STREAM_PARTITION_SIZE = 1ULL << 32;
+/** Partitions must stay below this so that their indices stay below 2^63. */
+static const uint32_t STREAM_PARTITION_MAX = (1U << 31) - 1;
 
 static nsim2023::GlobalValue g_rngSeed("RngSeed",
                                   "The global seed of all rng streams",
@@ -55,6 +67,14 @@ static nsim2023::GlobalValue g_rngRun("RngRun",
                                  nsim2023::UintegerValue(1),
                                  nsim2023::MakeUintegerChecker<uint64_t>());
 
+/**
+ * The generator behind the rng streams, see RngEngine.
+ */
+static nsim2023::GlobalValue g_rngEngine("RngEngine",
+                                    "The generator of all rng streams: MRG32k3a or Philox4x32",
+                                    nsim2023::StringValue("MRG32k3a"),
+                                    nsim2023::MakeStringChecker());
+
 uint32_t RngSeedManager::GetSeed()
 {
     NS_LOG_FUNCTION_NOARGS();
@@ -86,13 +106,87 @@ RngSeedManager::GetRun()
     return run;
 }
 
+std::string
+RngSeedManager::GetEngine()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    StringValue value;
+    g_rngEngine.GetValue(value);
+    return value.Get();
+}
+
+struct RngStreamPartitionCounter
+{
+    uint32_t partition;         //!< The partition
+    std::atomic<uint64_t> next; //!< Next stream index within the partition
+};
+
+namespace
+{
+
+/** The partition active on this thread, or null. */
+thread_local RngStreamPartitionCounter* g_currentPartition = nullptr;
+
+/**
+ * Find or create the counter of a partition.  Counters live as long as
+ * the program, so that re-entering a partition continues where it left.
+ */
+RngStreamPartitionCounter*
+GetPartitionCounter(uint32_t partition)
+{
+    static std::mutex mutex;
+    static std::map<uint32_t, std::unique_ptr<RngStreamPartitionCounter>> counters;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<RngStreamPartitionCounter>& counter = counters[partition];
+    if (!counter)
+    {
+        counter.reset(new RngStreamPartitionCounter);
+        counter->partition = partition;
+        counter->next = 0;
+    }
+    return counter.get();
+}
+
+} // namespace
+
 uint64_t
 RngSeedManager::GetNextStreamIndex()
 {
     NS_LOG_FUNCTION_NOARGS();
-    uint64_t next = g_nextStreamIndex;
-    g_nextStreamIndex++;
-    return next;
+    RngStreamPartitionCounter* partition = g_currentPartition;
+    if (partition == nullptr)
+    {
+        uint64_t next = g_nextStreamIndex.fetch_add(1, std::memory_order_relaxed);
+        NS_ABORT_MSG_IF(next >= STREAM_PARTITION_SIZE,
+                        "Automatic stream indices exhausted; use RngStreamPartition");
+        return next;
+    }
+    uint64_t local = partition->next.fetch_add(1, std::memory_order_relaxed);
+    NS_ABORT_MSG_IF(local >= STREAM_PARTITION_SIZE,
+                    "Stream partition " << partition->partition << " exhausted");
+    return (partition->partition + 1ULL) * STREAM_PARTITION_SIZE + local;
+}
+
+RngStreamPartition::RngStreamPartition(uint32_t partition)
+    : m_previous(g_currentPartition)
+{
+    NS_LOG_FUNCTION(this << partition);
+    NS_ABORT_MSG_IF(partition >= STREAM_PARTITION_MAX,
+                    "Stream partition " << partition << " out of range");
+    g_currentPartition = GetPartitionCounter(partition);
+}
+
+RngStreamPartition::~RngStreamPartition()
+{
+    NS_LOG_FUNCTION(this);
+    g_currentPartition = m_previous;
+}
+
+int64_t
+RngStreamPartition::GetCurrent()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    return g_currentPartition == nullptr ? -1 : g_currentPartition->partition;
 }
 
 }
@@ -23,6 +23,7 @@
 #define RNG_SEED_MANAGER_H
 
 #include <stdint.h>
+#include <string>
 
 
 namespace nsim2023
@@ -53,12 +54,71 @@ class RngSeedManager
      */
     static uint64_t GetRun();
 
+    /**
+     * Get the name of the RngEngine used for new streams.
+     */
+    static std::string GetEngine();
+
     /**
      * Get the next automatically assigned stream index.
+     *
+     * Inside an RngStreamPartition the index comes from the partition's
+     * own counter, otherwise from the counter shared by all threads.
+     * Either way the allocation is atomic.
      */
     static uint64_t GetNextStreamIndex();
 };
 
+/** Counter of the stream indices of one partition, see RngStreamPartition. */
+struct RngStreamPartitionCounter;
+
+/**
+ * Scope in which the calling thread draws automatically assigned stream
+ * indices from a partition of the stream space of its own.
+ *
+ * Partition p owns the indices [(p + 1) * 2^32, (p + 2) * 2^32), and
+ * hands them out in creation order; the shared counter keeps [0, 2^32).
+ * Giving each node (or logical process) its own partition makes its
+ * stream assignment independent of what other threads create meanwhile,
+ * so a scenario built in parallel gets the same streams as one built
+ * serially, provided each node creates its own objects in the same order.
+ *
+ * \code
+ *   for (uint32_t i = 0; i < nodes; i++) // possibly on several threads
+ *   {
+ *       RngStreamPartition partition(i);
+ *       BuildNode(i);
+ *   }
+ * \endcode
+ *
+ * Partitions nest; the destructor restores the enclosing one.
+ */
+class RngStreamPartition
+{
+  public:
+    /**
+     * Enter a partition on the calling thread.
+     * \param [in] partition The partition, below 2^31 - 1.
+     */
+    explicit RngStreamPartition(uint32_t partition);
+    /** Leave the partition, restoring the previous one. */
+    ~RngStreamPartition();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    RngStreamPartition(const RngStreamPartition&) = delete;
+    RngStreamPartition& operator=(const RngStreamPartition&) = delete;
+
+    /**
+     * Get the partition active on the calling thread.
+     * \returns The partition, or -1 outside of any partition.
+     */
+    static int64_t GetCurrent();
+
+  private:
+    /** The partition active before this one, or null. */
+    RngStreamPartitionCounter* m_previous;
+};
+
 /** Alias for compatibility. */
 typedef RngSeedManager SeedManager;
 
@@ -325,6 +325,93 @@ double RngStream::RandU01()
     return u;
 }
 
+void
+RngStream::Fill(double* values, std::size_t count)
+{
+    // Below this chunk length the jump ahead costs more than it saves
+    const int minLog2 = 8;
+    // Chunks of at most 2^16 numbers keep the output of the lanes in cache
+    const int maxLog2 = 16;
+
+    while (count >= (std::size_t(FILL_LANES) << minLog2))
+    {
+        int log2 = minLog2;
+        while (log2 < maxLog2 && count >= (std::size_t(FILL_LANES) << (log2 + 1)))
+        {
+            log2++;
+        }
+        const std::size_t chunk = std::size_t(1) << log2;
+
+        // Lane j starts j x 2^log2 numbers ahead of the current state
+        double state[6][FILL_LANES];
+        {
+            Matrix matrix1;
+            Matrix matrix2;
+            PowerOfTwoMatrix(log2, matrix1, matrix2);
+            double s[6];
+            for (int i = 0; i < 6; ++i)
+            {
+                s[i] = m_currentState[i];
+            }
+            for (int j = 0; j < FILL_LANES; ++j)
+            {
+                if (j > 0)
+                {
+                    MatVecModM(matrix1, s, s, m1);
+                    MatVecModM(matrix2, &s[3], &s[3], m2);
+                }
+                for (int i = 0; i < 6; ++i)
+                {
+                    state[i][j] = s[i];
+                }
+            }
+        }
+
+        // Same recurrence as RandU01, on all the lanes at once. The
+        // corrections are added as 0 or m instead of branching on them:
+        // the branches are unpredictable and adding 0.0 is exact.
+        for (std::size_t n = 0; n < chunk; ++n)
+        {
+            double u[FILL_LANES];
+            for (int j = 0; j < FILL_LANES; ++j)
+            {
+                double p1 = a12 * state[1][j] - a13n * state[0][j];
+                p1 -= static_cast<int32_t>(p1 / m1) * m1;
+                p1 += (p1 < 0.0) * m1;
+                state[0][j] = state[1][j];
+                state[1][j] = state[2][j];
+                state[2][j] = p1;
+
+                double p2 = a21 * state[5][j] - a23n * state[3][j];
+                p2 -= static_cast<int32_t>(p2 / m2) * m2;
+                p2 += (p2 < 0.0) * m2;
+                state[3][j] = state[4][j];
+                state[4][j] = state[5][j];
+                state[5][j] = p2;
+
+                u[j] = (p1 - p2 + (p1 <= p2) * m1) * norm;
+            }
+            for (int j = 0; j < FILL_LANES; ++j)
+            {
+                values[j * chunk + n] = u[j];
+            }
+        }
+
+        // The last lane ends where the stream continues
+        for (int i = 0; i < 6; ++i)
+        {
+            m_currentState[i] = state[i][FILL_LANES - 1];
+        }
+        values += FILL_LANES * chunk;
+        count -= FILL_LANES * chunk;
+    }
+
+    for (std::size_t n = 0; n < count; ++n)
+    {
+        values[n] = RandU01();
+    }
+}
+
 RngStream::RngStream(uint32_t seedNumber, uint64_t stream, uint64_t substream)
 {
     if (seedNumber >= m1 || seedNumber >= m2 || seedNumber == 0)
@@ -347,6 +434,30 @@ RngStream::RngStream(const RngStream& r)
     }
 }
 
+std::vector<RngStream>
+RngStream::CreateConsecutive(uint32_t seed, uint64_t stream, uint64_t substream, std::size_t count)
+{
+    std::vector<RngStream> streams;
+    if (count == 0)
+    {
+        return streams;
+    }
+    streams.reserve(count);
+    streams.emplace_back(seed, stream, substream);
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        streams.push_back(streams.back());
+        streams.back().AdvanceStreams(1);
+    }
+    return streams;
+}
+
+void
+RngStream::AdvanceStreams(uint64_t n)
+{
+    AdvanceNthBy(n, 127, m_currentState);
+}
+
 void RngStream::AdvanceNthBy(uint64_t nth, int by, double state[6])
 {
     Matrix matrix1;
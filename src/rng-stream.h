@@ -21,8 +21,13 @@
 
 #ifndef RNGSTREAM_H
 #define RNGSTREAM_H
+
+#include "rng-engine.h"
+
+#include <cstddef>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 
 namespace nsim2023
@@ -37,7 +42,7 @@ namespace nsim2023
  * class are explained in:
  * http://www.iro.umontreal.ca/~lecuyer/myftp/papers/streams00.pdf
  */
-class RngStream
+class RngStream : public RngEngine
 {
   public:
 
@@ -45,13 +50,47 @@ class RngStream
 
     RngStream(const RngStream& r);
 
+    /**
+     * Create \p count generators for the consecutive streams \p stream,
+     * \p stream + 1, ... of \p substream.
+     *
+     * Only the first one is built from the seed; each following one is a
+     * single jump of one stream away from its predecessor, which is much
+     * cheaper than constructing every stream on its own.
+     */
+    static std::vector<RngStream> CreateConsecutive(uint32_t seed,
+                                                    uint64_t stream,
+                                                    uint64_t substream,
+                                                    std::size_t count);
+
+    /**
+     * Jump \p n streams ahead, i.e. by n x 2^127 numbers.
+     *
+     * A generator at the start of stream s is moved to the start of
+     * stream s + n of the same substream.
+     */
+    void AdvanceStreams(uint64_t n);
+
     /**
      * Generate the next random number for this stream.
      * Uniformly distributed between 0 and 1.
      */
-    double RandU01();
+    double RandU01() override;
+
+    /**
+     * Fill \p values with the next \p count numbers of this stream.
+     *
+     * The output is identical to \p count calls of RandU01(). Large
+     * requests are split in FILL_LANES contiguous chunks whose start
+     * states are obtained by jumping ahead in the stream, so the
+     * recurrences of the chunks are independent and run side by side.
+     */
+    void Fill(double* values, std::size_t count) override;
 
   private:
+    /** Number of independent chunks generated side by side by Fill(). */
+    static constexpr int FILL_LANES = 4;
+
 
     void AdvanceNthBy(uint64_t nth, int by, double state[6]);
 
@@ -0,0 +1,185 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#include "scheduler-telemetry.h"
+
+#include "log.h"
+
+#include <cstring>
+#include <limits>
+
+
+namespace nsim2023
+{
+
+NS_LOG_COMPONENT_DEFINE("SchedulerTelemetry");
+
+/** Print a histogram as a JSON array, dropping the empty trailing buckets. */
+static void
+PrintHistogram(std::ostream& os, const uint64_t* histogram)
+{
+    uint32_t last = SchedulerTelemetry::BUCKETS;
+    while (last > 0 && histogram[last - 1] == 0)
+    {
+        last--;
+    }
+    os << "[";
+    for (uint32_t i = 0; i < last; i++)
+    {
+        os << (i > 0 ? "," : "") << histogram[i];
+    }
+    os << "]";
+}
+
+double
+SchedulerTelemetry::Snapshot::GetTombstoneRatio() const
+{
+    return (pending == 0) ? 0.0 : static_cast<double>(tombstones) / pending;
+}
+
+Time
+SchedulerTelemetry::Snapshot::GetHorizonSpread() const
+{
+    int64_t ts = now.GetTimeStep();
+    return (horizon > static_cast<uint64_t>(ts)) ? TimeStep(horizon - ts) : TimeStep(0);
+}
+
+double
+SchedulerTelemetry::Snapshot::GetEventsPerSimulatedSecond() const
+{
+    double seconds = now.GetSeconds();
+    return (seconds > 0) ? executed / seconds : 0.0;
+}
+
+void
+SchedulerTelemetry::Snapshot::Print(std::ostream& os) const
+{
+    os << "{\"time\":" << now.GetTimeStep() << ",\"wall\":" << wallSeconds
+       << ",\"inserted\":" << inserted << ",\"removed\":" << removed
+       << ",\"executed\":" << executed << ",\"skipped\":" << skipped
+       << ",\"pending\":" << pending << ",\"tombstones\":" << tombstones
+       << ",\"tombstoneRatio\":" << GetTombstoneRatio()
+       << ",\"horizonSpread\":" << GetHorizonSpread().GetTimeStep()
+       << ",\"eventsPerSimSecond\":" << GetEventsPerSimulatedSecond() << ",\"depth\":";
+    PrintHistogram(os, depthHistogram);
+    os << ",\"delay\":";
+    PrintHistogram(os, delayHistogram);
+    os << "}";
+}
+
+SchedulerTelemetry::SchedulerTelemetry()
+    : m_inserted(0),
+      m_removed(0),
+      m_executed(0),
+      m_skipped(0),
+      m_pending(0),
+      m_tombstones(0),
+      m_horizon(0),
+      m_start(std::chrono::steady_clock::now()),
+      m_interval(0),
+      m_nextDump(std::numeric_limits<uint64_t>::max()),
+      m_lastInserted(0),
+      m_lastRemoved(0),
+      m_lastExecuted(0),
+      m_lastTs(0),
+      m_lastWall(0)
+{
+    NS_LOG_FUNCTION(this);
+    std::memset(m_depthHistogram, 0, sizeof(m_depthHistogram));
+    std::memset(m_delayHistogram, 0, sizeof(m_delayHistogram));
+}
+
+SchedulerTelemetry::~SchedulerTelemetry()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_os.is_open())
+    {
+        m_os.close();
+    }
+}
+
+SchedulerTelemetry::Snapshot
+SchedulerTelemetry::GetSnapshot(uint64_t now) const
+{
+    Snapshot snapshot;
+    snapshot.now = TimeStep(now);
+    snapshot.wallSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    snapshot.inserted = m_inserted;
+    snapshot.removed = m_removed;
+    snapshot.executed = m_executed;
+    snapshot.skipped = m_skipped;
+    snapshot.pending = m_pending;
+    snapshot.tombstones = m_tombstones;
+    snapshot.horizon = m_horizon;
+    std::memcpy(snapshot.depthHistogram, m_depthHistogram, sizeof(m_depthHistogram));
+    std::memcpy(snapshot.delayHistogram, m_delayHistogram, sizeof(m_delayHistogram));
+    return snapshot;
+}
+
+void
+SchedulerTelemetry::SetOutput(const std::string& filename, const Time& interval)
+{
+    NS_LOG_FUNCTION(this << filename << interval);
+    if (m_os.is_open())
+    {
+        m_os.close();
+    }
+    m_nextDump = std::numeric_limits<uint64_t>::max();
+    if (filename.empty() || !interval.IsStrictlyPositive())
+    {
+        return;
+    }
+    m_os.open(filename);
+    if (!m_os.is_open())
+    {
+        NS_LOG_WARN("Unable to open telemetry file " << filename);
+        return;
+    }
+    m_interval = interval.GetTimeStep();
+    m_nextDump = 0;
+}
+
+void
+SchedulerTelemetry::Dump(uint64_t now)
+{
+    Snapshot snapshot = GetSnapshot(now);
+
+    double wall = snapshot.wallSeconds - m_lastWall;
+    double sim = TimeStep(now - m_lastTs).GetSeconds();
+    m_os << "{\"snapshot\":";
+    snapshot.Print(m_os);
+    m_os << ",\"insertRate\":" << ((wall > 0) ? (m_inserted - m_lastInserted) / wall : 0.0)
+         << ",\"removeRate\":"
+         << ((wall > 0) ? (m_removed + m_executed - m_lastRemoved - m_lastExecuted) / wall : 0.0)
+         << ",\"intervalEventsPerSimSecond\":"
+         << ((sim > 0) ? (m_executed - m_lastExecuted) / sim : 0.0) << "}\n";
+    m_os.flush();
+
+    m_lastInserted = m_inserted;
+    m_lastRemoved = m_removed;
+    m_lastExecuted = m_executed;
+    m_lastTs = now;
+    m_lastWall = snapshot.wallSeconds;
+    m_nextDump = (now / m_interval + 1) * m_interval;
+}
+
+}
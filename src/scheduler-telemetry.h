@@ -0,0 +1,193 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#ifndef SCHEDULER_TELEMETRY_H
+#define SCHEDULER_TELEMETRY_H
+
+#include "nstime.h"
+
+#include <chrono>
+#include <fstream>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+
+
+namespace nsim2023
+{
+
+/**
+ * Counters and histograms describing the state of the event queue.
+ *
+ * The simulator implementation updates these counters as events are
+ * inserted, removed, cancelled and executed. A consistent Snapshot can be
+ * taken at any time through Simulator::GetTelemetry(), and the snapshots
+ * can also be appended periodically (in simulation time) to a metrics file,
+ * one JSON object per line.
+ *
+ * Histograms use power-of-two buckets: bucket \c i counts the samples
+ * \c v with <tt>2^(i-1) <= v < 2^i</tt>, bucket 0 counts the zeros.
+ */
+class SchedulerTelemetry
+{
+  public:
+    /** Number of power-of-two histogram buckets. */
+    static constexpr uint32_t BUCKETS = 65;
+
+    /** A point-in-time copy of the telemetry counters. */
+    struct Snapshot
+    {
+        /** Current simulation time. */
+        Time now;
+        /** Wall-clock seconds since the telemetry was created. */
+        double wallSeconds;
+        /** Events inserted in the event queue. */
+        uint64_t inserted;
+        /** Events removed from the event queue with Simulator::Remove. */
+        uint64_t removed;
+        /** Events taken out of the event queue to be executed. */
+        uint64_t executed;
+        /** Cancelled events that were dequeued without being invoked. */
+        uint64_t skipped;
+        /** Events currently in the event queue. */
+        uint64_t pending;
+        /** Cancelled events still sitting in the event queue. */
+        uint64_t tombstones;
+        /** Largest timestamp ever inserted, in time steps. */
+        uint64_t horizon;
+        /** Queue depth sampled each time an event is executed. */
+        uint64_t depthHistogram[BUCKETS];
+        /** Distance, in time steps, between insertion time and expiration. */
+        uint64_t delayHistogram[BUCKETS];
+
+        /** Fraction of the pending events that are cancelled. */
+        double GetTombstoneRatio() const;
+        /** Time between now and the furthest event ever inserted. */
+        Time GetHorizonSpread() const;
+        /** Executed events per simulated second, since the beginning. */
+        double GetEventsPerSimulatedSecond() const;
+        /** Print the snapshot as a single-line JSON object. */
+        void Print(std::ostream& os) const;
+    };
+
+    SchedulerTelemetry();
+    ~SchedulerTelemetry();
+
+    /** Record an event with timestamp \p ts inserted at time \p now. */
+    inline void RecordInsert(uint64_t now, uint64_t ts)
+    {
+        m_inserted++;
+        m_pending++;
+        m_delayHistogram[Bucket(ts - now)]++;
+        if (ts > m_horizon)
+        {
+            m_horizon = ts;
+        }
+    }
+
+    /** Record an event removed from the queue before its expiration. */
+    inline void RecordRemove()
+    {
+        m_removed++;
+        m_pending--;
+    }
+
+    /** Record the cancel bit set on an event which is still queued. */
+    inline void RecordCancel()
+    {
+        m_tombstones++;
+    }
+
+    /** Record an event dequeued for execution. */
+    inline void RecordExecute(bool cancelled)
+    {
+        m_depthHistogram[Bucket(m_pending)]++;
+        m_executed++;
+        m_pending--;
+        if (cancelled)
+        {
+            m_skipped++;
+            if (m_tombstones > 0)
+            {
+                m_tombstones--;
+            }
+        }
+    }
+
+    /** Write a snapshot to the metrics file if the dump interval elapsed. */
+    inline void Poll(uint64_t now)
+    {
+        if (now >= m_nextDump)
+        {
+            Dump(now);
+        }
+    }
+
+    /** Build a snapshot of the counters at simulation time step \p now. */
+    Snapshot GetSnapshot(uint64_t now) const;
+
+    /**
+     * Append a snapshot to \p filename every \p interval of simulation time.
+     *
+     * An empty filename, or a non-positive interval, disables the output.
+     */
+    void SetOutput(const std::string& filename, const Time& interval);
+
+  private:
+    /** Power-of-two bucket index of \p v. */
+    static inline uint32_t Bucket(uint64_t v)
+    {
+        return (v == 0) ? 0 : 64 - __builtin_clzll(v);
+    }
+
+    /** Write a snapshot to the metrics file and arm the next dump. */
+    void Dump(uint64_t now);
+
+    uint64_t m_inserted;
+    uint64_t m_removed;
+    uint64_t m_executed;
+    uint64_t m_skipped;
+    uint64_t m_pending;
+    uint64_t m_tombstones;
+    uint64_t m_horizon;
+    uint64_t m_depthHistogram[BUCKETS];
+    uint64_t m_delayHistogram[BUCKETS];
+
+    /** Wall-clock reference for the snapshots. */
+    std::chrono::steady_clock::time_point m_start;
+
+    /** Metrics output file. */
+    std::ofstream m_os;
+    /** Dump interval, in time steps. */
+    uint64_t m_interval;
+    /** Time step of the next dump, or UINT64_MAX when disabled. */
+    uint64_t m_nextDump;
+    /** Counters at the previous dump, to compute the rates. */
+    uint64_t m_lastInserted;
+    uint64_t m_lastRemoved;
+    uint64_t m_lastExecuted;
+    uint64_t m_lastTs;
+    double m_lastWall;
+};
+
+}
+
+#endif /* SCHEDULER_TELEMETRY_H */
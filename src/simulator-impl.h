@@ -28,6 +28,7 @@
 #include "object-factory.h"
 #include "object.h"
 #include "ptr.h"
+#include "scheduler-telemetry.h"
 
 
 namespace nsim2023
@@ -86,6 +87,16 @@ class SimulatorImpl : public Object
 
     virtual uint64_t GetEventCount() const = 0;
 
+    /**
+     * Get a snapshot of the event queue telemetry.
+     */
+    virtual SchedulerTelemetry::Snapshot GetTelemetry() const = 0;
+
+    /**
+     * Periodically append the event queue telemetry to a file.
+     */
+    virtual void SetTelemetryOutput(const std::string& filename, const Time& interval) = 0;
+
     /**
      * Hook called before processing each event.
      */
@@ -27,6 +27,7 @@
 #include "global-value.h"
 #include "log.h"
 #include "map-scheduler.h"
+#include "object-arena.h"
 #include "object-factory.h"
 #include "ptr.h"
 #include "scheduler.h"
@@ -125,6 +126,10 @@ Simulator::Destroy()
 {
     NS_LOG_FUNCTION_NOARGS();
 
+    // The objects of this simulation go with their arena, the next
+    // simulation gets a new one
+    ObjectArena::Release();
+
     SimulatorImpl** pimpl = PeekImpl();
     if (*pimpl == nullptr)
     {
@@ -301,6 +306,19 @@ Simulator::GetEventCount()
     return GetImpl()->GetEventCount();
 }
 
+SchedulerTelemetry::Snapshot
+Simulator::GetTelemetry()
+{
+    return GetImpl()->GetTelemetry();
+}
+
+void
+Simulator::SetTelemetryOutput(const std::string& filename, const Time& interval)
+{
+    NS_LOG_FUNCTION(filename << interval);
+    GetImpl()->SetTelemetryOutput(filename, interval);
+}
+
 uint32_t
 Simulator::GetSystemId()
 {
@@ -27,6 +27,7 @@
 #include "make-event.h"
 #include "nstime.h"
 #include "object-factory.h"
+#include "scheduler-telemetry.h"
 #include "string"
 
 #include <stdint.h>
@@ -172,6 +173,21 @@ class Simulator
      */
     static uint64_t GetEventCount();
 
+    /**
+     * Get a snapshot of the event queue counters and histograms:
+     * queue depth, inserted/removed/executed events, cancelled events
+     * still queued, and the time horizon of the pending events.
+     */
+    static SchedulerTelemetry::Snapshot GetTelemetry();
+
+    /**
+     * Append a telemetry snapshot to \p filename every \p interval of
+     * simulation time, one JSON object per line. The snapshots are written
+     * while events are processed, so they do not keep the simulation alive.
+     * An empty filename disables the output.
+     */
+    static void SetTelemetryOutput(const std::string& filename, const Time& interval);
+
     /**
      * Schedule events (in the same context) to run at a future time.
      */
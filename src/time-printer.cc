@@ -34,6 +34,11 @@ namespace nsim2023
 NS_LOG_COMPONENT_DEFINE("TimePrinter");
 
 void DefaultTimePrinter(std::ostream& os)
+{
+    PrintTimeStep(os, Simulator::Now().GetTimeStep());
+}
+
+void PrintTimeStep(std::ostream& os, int64_t step)
 {
     std::ios_base::fmtflags ff = os.flags();
     std::streamsize oldPrecision = os.precision();
@@ -57,7 +62,7 @@ void DefaultTimePrinter(std::ostream& os)
         // default C++ precision of 5
         os << std::setprecision(5);
     }
-    os << Simulator::Now().As(Time::S);
+    os << Time(step).As(Time::S);
 
     os << std::setprecision(oldPrecision);
     os.flags(ff); // Restore stream flags
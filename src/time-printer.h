@@ -23,6 +23,7 @@
 #define TIME_PRINTER_H
 
 #include <ostream>
+#include <stdint.h>
 
 
 namespace nsim2023
@@ -32,6 +33,9 @@ typedef void (*TimePrinter)(std::ostream& os);
 
 void DefaultTimePrinter(std::ostream& os);
 
+// Print a time step the way DefaultTimePrinter prints the current time.
+void PrintTimeStep(std::ostream& os, int64_t step);
+
 }
 
 #endif /* TIME_H */
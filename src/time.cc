@@ -68,6 +68,17 @@ const long double* UNIT_VALUE = InitUnitValue();
 
 } // unnamed namespace
 
+#ifdef NSIM2023_TIME_FIXED_RESOLUTION
+
+// static
+bool
+Time::StaticInit()
+{
+    return false;
+}
+
+#else
+
 // The set of marked times
 // static
 Time::MarkedTimes* Time::g_markingTimes = nullptr;
@@ -102,6 +113,8 @@ Time::StaticInit()
     return firstTime;
 }
 
+#endif /* NSIM2023_TIME_FIXED_RESOLUTION */
+
 Time::Time(const std::string& s)
 {
     NS_LOG_FUNCTION(this << &s);
@@ -180,7 +193,11 @@ Time::SetDefaultNsResolution()
 {
     NS_LOG_FUNCTION_NOARGS();
     static struct Resolution resolution;
+#ifdef NSIM2023_TIME_FIXED_RESOLUTION
+    SetResolution(Time::FIXED_UNIT, &resolution, false);
+#else
     SetResolution(Time::NS, &resolution, false);
+#endif
     return resolution;
 }
 
@@ -189,7 +206,16 @@ void
 Time::SetResolution(enum Unit resolution)
 {
     NS_LOG_FUNCTION(resolution);
+#ifdef NSIM2023_TIME_FIXED_RESOLUTION
+    if (resolution != GetResolution())
+    {
+        NS_FATAL_ERROR("Time resolution is fixed at build time "
+                       "(NSIM2023_TIME_FIXED_RESOLUTION), it can't be changed to "
+                       << resolution);
+    }
+#else
     SetResolution(resolution, PeekResolution());
+#endif
 }
 
 // static
@@ -267,6 +293,35 @@ Time::SetResolution(enum Unit unit, struct Resolution* resolution, const bool co
     resolution->unit = unit;
 }
 
+#ifdef NSIM2023_TIME_FIXED_RESOLUTION
+
+// static
+void
+Time::ClearMarkedTimes()
+{
+}
+
+// static
+void
+Time::Mark(Time* const time)
+{
+}
+
+// static
+void
+Time::Clear(Time* const time)
+{
+}
+
+// static
+void
+Time::ConvertTimes(const enum Unit unit)
+{
+    NS_FATAL_ERROR("Time resolution is fixed at build time");
+}
+
+#else
+
 // static
 void
 Time::ClearMarkedTimes()
@@ -381,6 +436,8 @@ Time::ConvertTimes(const enum Unit unit)
 
 } // Time::ConvertTimes ()
 
+#endif /* NSIM2023_TIME_FIXED_RESOLUTION */
+
 // static
 enum Time::Unit
 Time::GetResolution()
@@ -395,6 +452,71 @@ Time::As(const enum Unit unit /* = Time::AUTO */) const
     return TimeWithUnit(*this, unit);
 }
 
+// static
+void
+Time::ToDoubles(const Time* times, std::size_t count, enum Unit unit, double* values)
+{
+#ifdef NSIM2023_TIME_FIXED_RESOLUTION
+    NS_ASSERT_MSG(FIXED_FACTOR[unit].isValid, "Attempted a conversion to an unavailable unit.");
+    const bool divide = FIXED_FACTOR[unit].fromMul;
+    const double factor = static_cast<double>(FIXED_FACTOR[unit].factor);
+#else
+    struct Information* info = PeekInformation(unit);
+    NS_ASSERT_MSG(info->isValid, "Attempted a conversion to an unavailable unit.");
+    const bool divide = !info->toMul;
+    const double factor = static_cast<double>(info->factor);
+#endif
+
+    if (divide)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            values[i] = static_cast<double>(times[i].m_data) / factor;
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            values[i] = static_cast<double>(times[i].m_data) * factor;
+        }
+    }
+}
+
+// static
+void
+Time::FromDoubles(const double* values, std::size_t count, enum Unit unit, Time* times)
+{
+#ifdef NSIM2023_TIME_FIXED_RESOLUTION
+    NS_ASSERT_MSG(FIXED_FACTOR[unit].isValid, "Attempted a conversion from an unavailable unit.");
+    const bool multiply = FIXED_FACTOR[unit].fromMul;
+    const int64_t factor = FIXED_FACTOR[unit].factor;
+#else
+    struct Information* info = PeekInformation(unit);
+    NS_ASSERT_MSG(info->isValid, "Attempted a conversion from an unavailable unit.");
+    const bool multiply = info->fromMul;
+    const int64_t factor = info->factor;
+#endif
+
+    if (multiply)
+    {
+        // Scale the integer part exactly, and round only the scaled fraction
+        for (std::size_t i = 0; i < count; i++)
+        {
+            int64_t integer = static_cast<int64_t>(values[i]);
+            double fraction = (values[i] - integer) * factor;
+            times[i].m_data = integer * factor + static_cast<int64_t>(std::round(fraction));
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            times[i].m_data = static_cast<int64_t>(std::round(values[i] / factor));
+        }
+    }
+}
+
 std::ostream&
 operator<<(std::ostream& os, const Time& time)
 {
@@ -26,8 +26,11 @@
 #include "singleton.h"
 #include "trace-source-accessor.h"
 
+#include <atomic>
+#include <functional>
 #include <iomanip>
-#include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -40,6 +43,246 @@ namespace nsim2023
 
 NS_LOG_COMPONENT_DEFINE("TypeId");
 
+namespace
+{
+
+/**
+ * \ingroup object
+ * \internal
+ * Open addressing hash table from 32-bit keys to non-zero 32-bit values,
+ * with linear probing.  Erasing shifts the following entries back, so
+ * probe sequences never cross tombstones.
+ */
+class IntTable
+{
+  public:
+    /**
+     * Find a key.
+     * \param [in] key The key.
+     * \returns The value of the key, or 0 if it is absent.
+     */
+    uint32_t Find(uint32_t key) const
+    {
+        if (m_slots.empty())
+        {
+            return 0;
+        }
+        std::size_t mask = m_slots.size() - 1;
+        for (std::size_t i = Home(key, mask);; i = (i + 1) & mask)
+        {
+            const Slot& slot = m_slots[i];
+            if (slot.value == 0 || slot.key == key)
+            {
+                return slot.value;
+            }
+        }
+    }
+
+    /**
+     * Insert or replace a key.
+     * \param [in] key The key.
+     * \param [in] value The non-zero value.
+     */
+    void Insert(uint32_t key, uint32_t value)
+    {
+        NS_ASSERT(value != 0);
+        if (2 * (m_size + 1) > m_slots.size())
+        {
+            Grow();
+        }
+        std::size_t mask = m_slots.size() - 1;
+        std::size_t i = Home(key, mask);
+        while (m_slots[i].value != 0 && m_slots[i].key != key)
+        {
+            i = (i + 1) & mask;
+        }
+        if (m_slots[i].value == 0)
+        {
+            m_size++;
+        }
+        m_slots[i] = {key, value};
+    }
+
+    /**
+     * Erase a key, if present.
+     * \param [in] key The key.
+     */
+    void Erase(uint32_t key)
+    {
+        if (m_slots.empty())
+        {
+            return;
+        }
+        std::size_t mask = m_slots.size() - 1;
+        std::size_t i = Home(key, mask);
+        while (m_slots[i].key != key)
+        {
+            if (m_slots[i].value == 0)
+            {
+                return;
+            }
+            i = (i + 1) & mask;
+        }
+        // Move back every following entry whose home is not in (i, j]
+        for (std::size_t j = (i + 1) & mask; m_slots[j].value != 0; j = (j + 1) & mask)
+        {
+            std::size_t home = Home(m_slots[j].key, mask);
+            if (((j - home) & mask) >= ((j - i) & mask))
+            {
+                m_slots[i] = m_slots[j];
+                i = j;
+            }
+        }
+        m_slots[i].value = 0;
+        m_size--;
+    }
+
+    /** Remove all keys. */
+    void Clear()
+    {
+        m_slots.clear();
+        m_size = 0;
+    }
+
+  private:
+    /** A key and its value; a value of 0 marks an empty slot. */
+    struct Slot
+    {
+        uint32_t key;   //!< The key.
+        uint32_t value; //!< The value.
+    };
+
+    /**
+     * The first slot probed for a key.
+     * \param [in] key The key.
+     * \param [in] mask The table size minus one.
+     * \returns The slot index.
+     */
+    static std::size_t Home(uint32_t key, std::size_t mask)
+    {
+        return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+    }
+
+    /** Double the number of slots and reinsert every entry. */
+    void Grow()
+    {
+        std::vector<Slot> slots(m_slots.empty() ? 16 : 2 * m_slots.size(), Slot{0, 0});
+        slots.swap(m_slots);
+        m_size = 0;
+        for (const Slot& slot : slots)
+        {
+            if (slot.value != 0)
+            {
+                Insert(slot.key, slot.value);
+            }
+        }
+    }
+
+    std::vector<Slot> m_slots; //!< The slots, a power of two of them.
+    std::size_t m_size{0};     //!< The number of keys.
+};
+
+/**
+ * \ingroup object
+ * \internal
+ * Open addressing hash table from strings to non-zero 32-bit values,
+ * with linear probing.  Keys are never removed.
+ */
+class StringTable
+{
+  public:
+    /**
+     * Find a key.
+     * \param [in] key The key.
+     * \returns The value of the key, or 0 if it is absent.
+     */
+    uint32_t Find(const std::string& key) const
+    {
+        if (m_slots.empty())
+        {
+            return 0;
+        }
+        std::size_t hash = std::hash<std::string>()(key);
+        std::size_t mask = m_slots.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask)
+        {
+            const Slot& slot = m_slots[i];
+            if (slot.value == 0 || (slot.hash == hash && slot.key == key))
+            {
+                return slot.value;
+            }
+        }
+    }
+
+    /**
+     * Insert a key which is not in the table yet.
+     * \param [in] key The key.
+     * \param [in] value The non-zero value.
+     */
+    void Insert(const std::string& key, uint32_t value)
+    {
+        NS_ASSERT(value != 0);
+        if (2 * (m_size + 1) > m_slots.size())
+        {
+            std::vector<Slot> slots(m_slots.empty() ? 64 : 2 * m_slots.size());
+            slots.swap(m_slots);
+            for (Slot& slot : slots)
+            {
+                if (slot.value != 0)
+                {
+                    Place(std::move(slot));
+                }
+            }
+        }
+        Place(Slot{std::hash<std::string>()(key), value, key});
+        m_size++;
+    }
+
+  private:
+    /** A key, its hash and its value; a value of 0 marks an empty slot. */
+    struct Slot
+    {
+        std::size_t hash{0}; //!< The hash of the key.
+        uint32_t value{0};   //!< The value.
+        std::string key;     //!< The key.
+    };
+
+    /**
+     * Store an entry in the first free slot of its probe sequence.
+     * \param [in] slot The entry.
+     */
+    void Place(Slot&& slot)
+    {
+        std::size_t mask = m_slots.size() - 1;
+        std::size_t i = slot.hash & mask;
+        while (m_slots[i].value != 0)
+        {
+            i = (i + 1) & mask;
+        }
+        m_slots[i] = std::move(slot);
+    }
+
+    std::vector<Slot> m_slots; //!< The slots, a power of two of them.
+    std::size_t m_size{0};     //!< The number of keys.
+};
+
+/**
+ * \ingroup object
+ * \internal
+ * The attributes or trace sources of a type and of its parents, by
+ * interned name.  Each value packs the uid of the type which registered
+ * the name in the high 16 bits and its index there in the low 16 bits.
+ */
+struct NameIndex
+{
+    /** The structure generation the entries were built for. */
+    std::atomic<uint64_t> generation{~0ULL};
+    /** Interned name to owner and index. */
+    IntTable entries;
+};
+
+}
+
 
 class IidManager : public Singleton<IidManager>
 {
@@ -97,6 +340,9 @@ class IidManager : public Singleton<IidManager>
 
     std::size_t GetAttributeN(uint16_t uid) const;
 
+    /** Get the generation of the attributes of all types. */
+    uint64_t GetAttributeGeneration() const;
+
     struct TypeId::AttributeInformation GetAttribute(uint16_t uid, std::size_t i) const;
 
     void AddTraceSource(uint16_t uid,
@@ -111,6 +357,24 @@ class IidManager : public Singleton<IidManager>
 
     struct TypeId::TraceSourceInformation GetTraceSource(uint16_t uid, std::size_t i) const;
 
+    /**
+     * Find an attribute of a type or of its parents.
+     * \param [in] uid The type id.
+     * \param [in] name The attribute name.
+     * \returns The attribute, or \c nullptr if there is none of that name.
+     */
+    const struct TypeId::AttributeInformation* LookupAttribute(uint16_t uid,
+                                                               const std::string& name) const;
+
+    /**
+     * Find a trace source of a type or of its parents.
+     * \param [in] uid The type id.
+     * \param [in] name The trace source name.
+     * \returns The trace source, or \c nullptr if there is none of that name.
+     */
+    const struct TypeId::TraceSourceInformation* LookupTraceSource(uint16_t uid,
+                                                                   const std::string& name) const;
+
     bool MustHideFromDocumentation(uint16_t uid) const;
 
   private:
@@ -121,6 +385,12 @@ class IidManager : public Singleton<IidManager>
 
     static TypeId::hash_t Hasher(const std::string name);
 
+    /**
+     * Intern an attribute or trace source name.
+     * \param [in] name The name.
+     */
+    void InternName(const std::string& name);
+
     /** The information record about a single type id. */
     struct IidInformation
     {
@@ -148,6 +418,10 @@ class IidManager : public Singleton<IidManager>
         TypeId::SupportLevel supportLevel;
         /** Support message. */
         std::string supportMsg;
+        /** The attributes of this type and its parents, by name. */
+        std::shared_ptr<NameIndex> attributeIndex;
+        /** The trace sources of this type and its parents, by name. */
+        std::shared_ptr<NameIndex> traceSourceIndex;
     };
     /** Iterator type. */
     typedef std::vector<struct IidInformation>::const_iterator Iterator;
@@ -159,18 +433,36 @@ class IidManager : public Singleton<IidManager>
      */
     struct IidManager::IidInformation* LookupInformation(uint16_t uid) const;
 
+    /**
+     * Get the attribute or trace source index of a type, rebuilding it if
+     * a type was reparented or given a new name since it was built.
+     * \param [in] uid The type id.
+     * \param [in] traceSources \c true for the trace source index.
+     * \returns The index entries.
+     */
+    const IntTable& GetNameIndex(uint16_t uid, bool traceSources) const;
+
     /** The container of all type id records. */
     std::vector<struct IidInformation> m_information;
 
-    /** Type of the by-name index. */
-    typedef std::map<std::string, uint16_t> namemap_t;
     /** The by-name index. */
-    namemap_t m_namemap;
+    StringTable m_namemap;
 
-    /** Type of the by-hash index. */
-    typedef std::map<TypeId::hash_t, uint16_t> hashmap_t;
     /** The by-hash index. */
-    hashmap_t m_hashmap;
+    IntTable m_hashmap;
+
+    /** The interned attribute and trace source names. */
+    StringTable m_names;
+    /** The number of interned names. */
+    uint32_t m_namesN{0};
+
+    /** Incremented when a type gets a parent, an attribute or a trace source. */
+    std::atomic<uint64_t> m_structureGeneration{0};
+    /** Serializes the rebuilding of the name indexes. */
+    mutable std::mutex m_indexMutex;
+
+    /** Incremented when an attribute is added or its initial value changes. */
+    std::atomic<uint64_t> m_attributeGeneration{0};
 
     /** IidManager constants. */
     enum
@@ -211,10 +503,10 @@ IidManager::AllocateUid(std::string name)
 {
     NS_LOG_FUNCTION(IID << name);
     // Type names are definitive: equal names are equal types
-    NS_ASSERT_MSG(m_namemap.count(name) == 0, "Trying to allocate twice the same uid: " << name);
+    NS_ASSERT_MSG(m_namemap.Find(name) == 0, "Trying to allocate twice the same uid: " << name);
 
     TypeId::hash_t hash = Hasher(name) & (~HashChainFlag);
-    if (m_hashmap.count(hash) == 1)
+    if (m_hashmap.Find(hash) != 0)
     {
         NS_LOG_ERROR("Hash chaining TypeId for '"
                      << name << "'.  "
@@ -232,7 +524,7 @@ IidManager::AllocateUid(std::string name)
         //  Oh, by the way, I owe you a beer, since I bet Mathieu that
         //  this would never happen..  -- Peter Barnes, LLNL
 
-        NS_ASSERT_MSG(m_hashmap.count(hash | HashChainFlag) == 0,
+        NS_ASSERT_MSG(m_hashmap.Find(hash | HashChainFlag) == 0,
                       "Triplicate hash detected while chaining TypeId for '"
                           << name << "'. Please contact the developers for assistance.");
         // Developer contacted about this message:
@@ -252,9 +544,9 @@ IidManager::AllocateUid(std::string name)
         { // chain old type
             NS_LOG_LOGIC(IIDL << "Old TypeId '" << hinfo->name << "' getting chained.");
             uint16_t oldUid = GetUid(hinfo->hash);
-            m_hashmap.erase(m_hashmap.find(hinfo->hash));
+            m_hashmap.Erase(hinfo->hash);
             hinfo->hash = hash | HashChainFlag;
-            m_hashmap.insert(std::make_pair(hinfo->hash, oldUid));
+            m_hashmap.Insert(hinfo->hash, oldUid);
             // leave new hash unchained
         }
     }
@@ -268,14 +560,16 @@ IidManager::AllocateUid(std::string name)
     information.hasConstructor = false;
     information.mustHideFromDocumentation = false;
     information.supportLevel = TypeId::SUPPORTED;
+    information.attributeIndex = std::make_shared<NameIndex>();
+    information.traceSourceIndex = std::make_shared<NameIndex>();
     m_information.push_back(information);
     std::size_t tuid = m_information.size();
     NS_ASSERT(tuid <= 0xffff);
     uint16_t uid = static_cast<uint16_t>(tuid);
 
     // Add to both maps:
-    m_namemap.insert(std::make_pair(name, uid));
-    m_hashmap.insert(std::make_pair(hash, uid));
+    m_namemap.Insert(name, uid);
+    m_hashmap.Insert(hash, uid);
     NS_LOG_LOGIC(IIDL << uid);
     return uid;
 }
@@ -296,6 +590,7 @@ IidManager::SetParent(uint16_t uid, uint16_t parent)
     NS_ASSERT(parent <= m_information.size());
     struct IidInformation* information = LookupInformation(uid);
     information->parent = parent;
+    m_structureGeneration++;
 }
 
 void
@@ -339,12 +634,7 @@ uint16_t
 IidManager::GetUid(std::string name) const
 {
     NS_LOG_FUNCTION(IID << name);
-    uint16_t uid = 0;
-    namemap_t::const_iterator it = m_namemap.find(name);
-    if (it != m_namemap.end())
-    {
-        uid = it->second;
-    }
+    uint16_t uid = static_cast<uint16_t>(m_namemap.Find(name));
     NS_LOG_LOGIC(IIDL << uid);
     return uid;
 }
@@ -353,12 +643,7 @@ uint16_t
 IidManager::GetUid(TypeId::hash_t hash) const
 {
     NS_LOG_FUNCTION(IID << hash);
-    hashmap_t::const_iterator it = m_hashmap.find(hash);
-    uint16_t uid = 0;
-    if (it != m_hashmap.end())
-    {
-        uid = it->second;
-    }
+    uint16_t uid = static_cast<uint16_t>(m_hashmap.Find(hash));
     NS_LOG_LOGIC(IIDL << uid);
     return uid;
 }
@@ -516,6 +801,9 @@ IidManager::AddAttribute(uint16_t uid,
     info.supportLevel = supportLevel;
     info.supportMsg = supportMsg;
     information->attributes.push_back(info);
+    InternName(name);
+    m_attributeGeneration++;
+    m_structureGeneration++;
     NS_LOG_LOGIC(IIDL << information->attributes.size() - 1);
 }
 
@@ -528,6 +816,7 @@ IidManager::SetAttributeInitialValue(uint16_t uid,
     struct IidInformation* information = LookupInformation(uid);
     NS_ASSERT(i < information->attributes.size());
     information->attributes[i].initialValue = initialValue;
+    m_attributeGeneration++;
 }
 
 std::size_t
@@ -540,6 +829,12 @@ IidManager::GetAttributeN(uint16_t uid) const
     return size;
 }
 
+uint64_t
+IidManager::GetAttributeGeneration() const
+{
+    return m_attributeGeneration.load(std::memory_order_acquire);
+}
+
 struct TypeId::AttributeInformation
 IidManager::GetAttribute(uint16_t uid, std::size_t i) const
 {
@@ -607,6 +902,8 @@ IidManager::AddTraceSource(uint16_t uid,
     source.supportLevel = supportLevel;
     source.supportMsg = supportMsg;
     information->traceSources.push_back(source);
+    InternName(name);
+    m_structureGeneration++;
     NS_LOG_LOGIC(IIDL << information->traceSources.size() - 1);
 }
 
@@ -630,6 +927,88 @@ IidManager::GetTraceSource(uint16_t uid, std::size_t i) const
     return information->traceSources[i];
 }
 
+void
+IidManager::InternName(const std::string& name)
+{
+    NS_LOG_FUNCTION(IID << name);
+    if (m_names.Find(name) == 0)
+    {
+        m_names.Insert(name, ++m_namesN);
+    }
+}
+
+const IntTable&
+IidManager::GetNameIndex(uint16_t uid, bool traceSources) const
+{
+    NS_LOG_FUNCTION(IID << uid << traceSources);
+    struct IidInformation* information = LookupInformation(uid);
+    NameIndex& index = traceSources ? *information->traceSourceIndex : *information->attributeIndex;
+    uint64_t generation = m_structureGeneration.load(std::memory_order_acquire);
+    if (index.generation.load(std::memory_order_acquire) == generation)
+    {
+        return index.entries;
+    }
+
+    std::lock_guard<std::mutex> lock(m_indexMutex);
+    if (index.generation.load(std::memory_order_relaxed) != generation)
+    {
+        std::vector<uint16_t> chain;
+        for (uint16_t tid = uid;; tid = information->parent)
+        {
+            chain.push_back(tid);
+            information = LookupInformation(tid);
+            if (information->parent == tid)
+            {
+                break;
+            }
+        }
+        // Insert from the root down, so a child's name hides its parents'
+        index.entries.Clear();
+        for (auto tid = chain.rbegin(); tid != chain.rend(); ++tid)
+        {
+            information = LookupInformation(*tid);
+            std::size_t n = traceSources ? information->traceSources.size()
+                                         : information->attributes.size();
+            NS_ASSERT(n <= 0x10000);
+            for (std::size_t i = 0; i < n; i++)
+            {
+                const std::string& name = traceSources ? information->traceSources[i].name
+                                                       : information->attributes[i].name;
+                index.entries.Insert(m_names.Find(name),
+                                     (static_cast<uint32_t>(*tid) << 16) | static_cast<uint32_t>(i));
+            }
+        }
+        index.generation.store(generation, std::memory_order_release);
+    }
+    return index.entries;
+}
+
+const struct TypeId::AttributeInformation*
+IidManager::LookupAttribute(uint16_t uid, const std::string& name) const
+{
+    NS_LOG_FUNCTION(IID << uid << name);
+    uint32_t key = m_names.Find(name);
+    uint32_t entry = key == 0 ? 0 : GetNameIndex(uid, false).Find(key);
+    if (entry == 0)
+    {
+        return nullptr;
+    }
+    return &LookupInformation(entry >> 16)->attributes[entry & 0xffff];
+}
+
+const struct TypeId::TraceSourceInformation*
+IidManager::LookupTraceSource(uint16_t uid, const std::string& name) const
+{
+    NS_LOG_FUNCTION(IID << uid << name);
+    uint32_t key = m_names.Find(name);
+    uint32_t entry = key == 0 ? 0 : GetNameIndex(uid, true).Find(key);
+    if (entry == 0)
+    {
+        return nullptr;
+    }
+    return &LookupInformation(entry >> 16)->traceSources[entry & 0xffff];
+}
+
 bool
 IidManager::MustHideFromDocumentation(uint16_t uid) const
 {
@@ -715,6 +1094,12 @@ TypeId::GetRegisteredN()
     return IidManager::Get()->GetRegisteredN();
 }
 
+uint64_t
+TypeId::GetAttributeGeneration()
+{
+    return IidManager::Get()->GetAttributeGeneration();
+}
+
 TypeId
 TypeId::GetRegistered(uint16_t i)
 {
@@ -726,38 +1111,24 @@ bool
 TypeId::LookupAttributeByName(std::string name, struct TypeId::AttributeInformation* info) const
 {
     NS_LOG_FUNCTION(this << name << info);
-    TypeId tid;
-    TypeId nextTid = *this;
-    do
+    const struct TypeId::AttributeInformation* found =
+        IidManager::Get()->LookupAttribute(m_tid, name);
+    if (found == nullptr)
     {
-        tid = nextTid;
-        for (std::size_t i = 0; i < tid.GetAttributeN(); i++)
-        {
-            struct TypeId::AttributeInformation tmp = tid.GetAttribute(i);
-            if (tmp.name == name)
-            {
-                if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                    *info = tmp;
-                    return true;
-                }
-                else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                    std::cerr << "Attribute '" << name << "' is deprecated: " << tmp.supportMsg
-                              << std::endl;
-                    *info = tmp;
-                    return true;
-                }
-                else if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                    NS_FATAL_ERROR("Attribute '" << name << "' is obsolete, with no fallback: "
-                                                 << tmp.supportMsg);
-                }
-            }
-        }
-        nextTid = tid.GetParent();
-    } while (nextTid != tid);
-    return false;
+        return false;
+    }
+    if (found->supportLevel == TypeId::DEPRECATED)
+    {
+        std::cerr << "Attribute '" << name << "' is deprecated: " << found->supportMsg
+                  << std::endl;
+    }
+    else if (found->supportLevel == TypeId::OBSOLETE)
+    {
+        NS_FATAL_ERROR("Attribute '" << name << "' is obsolete, with no fallback: "
+                                     << found->supportMsg);
+    }
+    *info = *found;
+    return true;
 }
 
 TypeId
@@ -992,39 +1363,24 @@ Ptr<const TraceSourceAccessor>
 TypeId::LookupTraceSourceByName(std::string name, struct TraceSourceInformation* info) const
 {
     NS_LOG_FUNCTION(this << name);
-    TypeId tid;
-    TypeId nextTid = *this;
-    struct TypeId::TraceSourceInformation tmp;
-    do
+    const struct TypeId::TraceSourceInformation* found =
+        IidManager::Get()->LookupTraceSource(m_tid, name);
+    if (found == nullptr)
     {
-        tid = nextTid;
-        for (std::size_t i = 0; i < tid.GetTraceSourceN(); i++)
-        {
-            tmp = tid.GetTraceSource(i);
-            if (tmp.name == name)
-            {
-                if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                    *info = tmp;
-                    return tmp.accessor;
-                }
-                else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                    std::cerr << "TraceSource '" << name << "' is deprecated: " << tmp.supportMsg
-                              << std::endl;
-                    *info = tmp;
-                    return tmp.accessor;
-                }
-                else if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                    NS_FATAL_ERROR("TraceSource '" << name << "' is obsolete, with no fallback: "
-                                                   << tmp.supportMsg);
-                }
-            }
-        }
-        nextTid = tid.GetParent();
-    } while (nextTid != tid);
-    return nullptr;
+        return nullptr;
+    }
+    if (found->supportLevel == TypeId::DEPRECATED)
+    {
+        std::cerr << "TraceSource '" << name << "' is deprecated: " << found->supportMsg
+                  << std::endl;
+    }
+    else if (found->supportLevel == TypeId::OBSOLETE)
+    {
+        NS_FATAL_ERROR("TraceSource '" << name << "' is obsolete, with no fallback: "
+                                       << found->supportMsg);
+    }
+    *info = *found;
+    return found->accessor;
 }
 
 Ptr<const TraceSourceAccessor>
@@ -1034,13 +1390,6 @@ TypeId::LookupTraceSourceByName(std::string name) const
     return LookupTraceSourceByName(name, &info);
 }
 
-uint16_t
-TypeId::GetUid() const
-{
-    NS_LOG_FUNCTION(this);
-    return m_tid;
-}
-
 void
 TypeId::SetUid(uint16_t uid)
 {
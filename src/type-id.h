@@ -115,6 +115,13 @@ class TypeId
 
     static TypeId GetRegistered(uint16_t i);
 
+    /**
+     * Get the generation of the attributes of all the TypeIds, incremented
+     * when an attribute is added or its initial value changes, e.g. by
+     * Config::SetDefault, so that caches of them know to rebuild.
+     */
+    static uint64_t GetAttributeGeneration();
+
     explicit TypeId(const std::string& name);
 
     /**
@@ -223,7 +230,7 @@ class TypeId
     /**
      * Get the internal id of this TypeId.
      */
-    uint16_t GetUid() const;
+    inline uint16_t GetUid() const;
 
     void SetUid(uint16_t uid);
 
@@ -288,6 +295,12 @@ TypeId::~TypeId()
 {
 }
 
+uint16_t
+TypeId::GetUid() const
+{
+    return m_tid;
+}
+
 inline bool
 operator==(TypeId a, TypeId b)
 {
@@ -22,3 +22,33 @@ g++ ${ARGS} test4.cc -I../src/
 g++ test4.o -L../lib/ -o test4 -lnsim2023 -lstdc++fs -lpthread
 echo "compile test4 done"
 
+
+echo "compile test5"
+g++ ${ARGS} test5.cc -I../src/
+g++ test5.o -L../lib/ -o test5 -lnsim2023 -lstdc++fs -lpthread
+echo "compile test5 done"
+
+echo "compile test6"
+g++ ${ARGS} test6.cc -I../src/
+g++ test6.o -L../lib/ -o test6 -lnsim2023 -lstdc++fs -lpthread
+echo "compile test6 done"
+
+echo "compile test7"
+g++ ${ARGS} test7.cc -I../src/
+g++ test7.o -L../lib/ -o test7 -lnsim2023 -lstdc++fs -lpthread
+echo "compile test7 done"
+
+echo "compile test8"
+g++ ${ARGS} -DNSIM2023_LOG_ENABLE test8.cc -I../src/
+g++ test8.o -L../lib/ -o test8 -lnsim2023 -lstdc++fs -lpthread
+echo "compile test8 done"
+
+echo "compile test9"
+g++ ${ARGS} test9.cc -I../src/
+g++ test9.o -L../lib/ -o test9 -lnsim2023 -lstdc++fs -lpthread
+echo "compile test9 done"
+
+echo "compile test10"
+g++ ${ARGS} test10.cc -I../src/
+g++ test10.o -L../lib/ -o test10 -lnsim2023 -lstdc++fs -lpthread
+echo "compile test10 done"
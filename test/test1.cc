@@ -85,6 +85,9 @@ int main(int argc, char* argv[])
 
     Simulator::Run();
 
+    Simulator::GetTelemetry().Print(std::cout);
+    std::cout << std::endl;
+
     Simulator::Destroy();
 
     return 0;
@@ -0,0 +1,358 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+
+#include "config.h"
+#include "names.h"
+#include "object-ptr-container.h"
+#include "object.h"
+#include "pointer.h"
+#include "uinteger.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace nsim2023;
+
+/**
+ * Checks Config path resolution through containers, pointers, aggregates
+ * and names, compiled paths and the match cache, and measures the time
+ * of Config::Set.
+ */
+
+/** A queue, reached through a pointer attribute. */
+class Queue : public Object
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    uint32_t m_limit; //!< The limit
+};
+
+NS_OBJECT_ENSURE_REGISTERED(Queue);
+
+TypeId
+Queue::GetTypeId()
+{
+    static TypeId tid = TypeId("nsim2023::Queue")
+                            .SetParent<Object>()
+                            .AddConstructor<Queue>()
+                            .AddAttribute("Limit",
+                                          "The limit.",
+                                          UintegerValue(100),
+                                          MakeUintegerAccessor(&Queue::m_limit),
+                                          MakeUintegerChecker<uint32_t>());
+    return tid;
+}
+
+/** A device, in a container attribute of a node. */
+class Device : public Object
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    uint32_t m_mtu;       //!< The MTU
+    Ptr<Queue> m_queue;   //!< The queue
+};
+
+NS_OBJECT_ENSURE_REGISTERED(Device);
+
+TypeId
+Device::GetTypeId()
+{
+    static TypeId tid = TypeId("nsim2023::Device")
+                            .SetParent<Object>()
+                            .AddConstructor<Device>()
+                            .AddAttribute("Mtu",
+                                          "The MTU.",
+                                          UintegerValue(1500),
+                                          MakeUintegerAccessor(&Device::m_mtu),
+                                          MakeUintegerChecker<uint32_t>())
+                            .AddAttribute("Queue",
+                                          "The queue.",
+                                          PointerValue(),
+                                          MakePointerAccessor(&Device::m_queue),
+                                          MakePointerChecker<Queue>());
+    return tid;
+}
+
+/** A node with devices. */
+class Node : public Object
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** \return The number of devices. */
+    std::size_t GetNDevices() const
+    {
+        return m_devices.size();
+    }
+
+    /**
+     * \param [in] i The index.
+     * \return A device.
+     */
+    Ptr<Device> GetDevice(std::size_t i) const
+    {
+        return m_devices[i];
+    }
+
+    std::vector<Ptr<Device>> m_devices; //!< The devices
+};
+
+NS_OBJECT_ENSURE_REGISTERED(Node);
+
+TypeId
+Node::GetTypeId()
+{
+    static TypeId tid = TypeId("nsim2023::Node")
+                            .SetParent<Object>()
+                            .AddConstructor<Node>()
+                            .AddAttribute("DeviceList",
+                                          "The devices.",
+                                          ObjectPtrContainerValue(),
+                                          MakeObjectPtrContainerAccessor(&Node::GetDevice,
+                                                                         &Node::GetNDevices),
+                                          MakeObjectPtrContainerChecker<Device>());
+    return tid;
+}
+
+/** The root of the paths, holding the nodes. */
+class Network : public Object
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** \return The number of nodes. */
+    std::size_t GetNNodes() const
+    {
+        return m_nodes.size();
+    }
+
+    /**
+     * \param [in] i The index.
+     * \return A node.
+     */
+    Ptr<Node> GetNode(std::size_t i) const
+    {
+        return m_nodes[i];
+    }
+
+    std::vector<Ptr<Node>> m_nodes; //!< The nodes
+};
+
+NS_OBJECT_ENSURE_REGISTERED(Network);
+
+TypeId
+Network::GetTypeId()
+{
+    static TypeId tid = TypeId("nsim2023::Network")
+                            .SetParent<Object>()
+                            .AddAttribute("NodeList",
+                                          "The nodes.",
+                                          ObjectPtrContainerValue(),
+                                          MakeObjectPtrContainerAccessor(&Network::GetNode,
+                                                                         &Network::GetNNodes),
+                                          MakeObjectPtrContainerChecker<Node>());
+    return tid;
+}
+
+/** An object aggregated to some nodes. */
+class Mobility : public Object
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    uint32_t m_speed; //!< The speed
+};
+
+NS_OBJECT_ENSURE_REGISTERED(Mobility);
+
+TypeId
+Mobility::GetTypeId()
+{
+    static TypeId tid = TypeId("nsim2023::Mobility")
+                            .SetParent<Object>()
+                            .AddConstructor<Mobility>()
+                            .AddAttribute("Speed",
+                                          "The speed.",
+                                          UintegerValue(0),
+                                          MakeUintegerAccessor(&Mobility::m_speed),
+                                          MakeUintegerChecker<uint32_t>());
+    return tid;
+}
+
+/**
+ * Add a node with devices to the network.
+ * \param [in] network The network.
+ * \param [in] devices The number of devices.
+ * \return The node.
+ */
+static Ptr<Node>
+AddNode(Ptr<Network> network, int devices)
+{
+    Ptr<Node> node = CreateObject<Node>();
+    for (int i = 0; i < devices; i++)
+    {
+        Ptr<Device> device = CreateObject<Device>();
+        device->m_queue = CreateObject<Queue>();
+        node->m_devices.push_back(device);
+    }
+    network->m_nodes.push_back(node);
+    return node;
+}
+
+/**
+ * Check that a path matches \p n objects the same way as a string and
+ * compiled.
+ * \param [in] path The path.
+ * \param [in] n The expected number of matches.
+ * \return Whether the path matched as expected.
+ */
+static bool
+Matches(std::string path, std::size_t n)
+{
+    Config::MatchContainer matches = Config::LookupMatches(path);
+    Config::MatchContainer compiled = Config::LookupMatches(Config::CompilePath(path));
+    bool same = matches.GetN() == compiled.GetN() && compiled.GetPath() == path;
+    for (std::size_t i = 0; same && i < matches.GetN(); i++)
+    {
+        same = matches.Get(i) == compiled.Get(i) &&
+               matches.GetMatchedPath(i) == compiled.GetMatchedPath(i);
+    }
+    if (!same || matches.GetN() != n)
+    {
+        std::cout << path << ": " << matches.GetN() << " matches, expected " << n << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    Ptr<Network> network = CreateObject<Network>();
+    Config::RegisterRootNamespaceObject(network);
+    for (int i = 0; i < 10; i++)
+    {
+        AddNode(network, 3);
+    }
+    network->m_nodes[4]->AggregateObject(CreateObject<Mobility>());
+    network->m_nodes[6]->AggregateObject(CreateObject<Mobility>());
+    Names::Add("server", network->m_nodes[2]);
+
+    bool resolved = Matches("/NodeList/*", 10) && Matches("NodeList/*/DeviceList/*", 30) &&
+                    Matches("/NodeList/[2-4]|7/DeviceList/1|0/", 8) &&
+                    Matches("/NodeList/*/DeviceList/2/Queue", 10) &&
+                    Matches("/NodeList/*/$nsim2023::Mobility", 2) &&
+                    Matches("/NodeList/*/$nsim2023::Device", 0) &&
+                    Matches("/NodeList/*/*/0", 10) && Matches("/NodeList/12", 0) &&
+                    Matches("/Names/server/DeviceList/*", 3) && Matches("/NoSuchList/*", 0);
+    Config::MatchContainer contexts = Config::LookupMatches("/NodeList/3/DeviceList/2/Queue");
+    resolved = resolved && contexts.GetN() == 1 &&
+               contexts.GetMatchedPath(0) == "/NodeList/3/DeviceList/2/Queue/";
+    std::cout << "paths " << (resolved ? "resolve" : "fail") << std::endl;
+
+    Config::Set("/NodeList/[1-3]/DeviceList/0/Mtu", UintegerValue(9000));
+    Config::Set("/Names/server/DeviceList/2/Queue/Limit", UintegerValue(7));
+    Config::Set("/NodeList/*/$nsim2023::Mobility/Speed", UintegerValue(5));
+    bool set = network->m_nodes[0]->m_devices[0]->m_mtu == 1500 &&
+               network->m_nodes[3]->m_devices[0]->m_mtu == 9000 &&
+               network->m_nodes[3]->m_devices[1]->m_mtu == 1500 &&
+               network->m_nodes[2]->m_devices[2]->m_queue->m_limit == 7 &&
+               network->m_nodes[6]->GetObject<Mobility>()->m_speed == 5;
+    std::cout << "attributes " << (set ? "set" : "lost") << std::endl;
+
+    // Remembered matches follow the changes the Config system can see
+    Config::EnableMatchCache();
+    bool cached = Matches("/NodeList/*/$nsim2023::Mobility", 2);
+    network->m_nodes[8]->AggregateObject(CreateObject<Mobility>());
+    cached = cached && Matches("/NodeList/*/$nsim2023::Mobility", 3);
+    Ptr<Queue> queue = CreateObject<Queue>();
+    Config::Set("/NodeList/0/DeviceList/0/Queue", PointerValue(queue));
+    Config::Set("/NodeList/0/DeviceList/0/Queue/Limit", UintegerValue(11));
+    cached = cached && queue->m_limit == 11 && Matches("/Names/*", 0) &&
+             Matches("/Names/server", 1);
+    Names::Add("client", network->m_nodes[5]);
+    cached = cached && Matches("/Names/client/DeviceList/*", 3);
+    AddNode(network, 3);
+    Config::InvalidateMatchCache();
+    cached = cached && Matches("/NodeList/*", 11);
+    std::cout << "cache " << (cached ? "follows" : "misses") << " the object graph" << std::endl;
+
+    for (int i = 0; i < 989; i++)
+    {
+        AddNode(network, 3);
+    }
+    Config::InvalidateMatchCache();
+    const int count = 50000;
+    for (int cache = 0; cache < 2; cache++)
+    {
+        if (cache)
+        {
+            Config::EnableMatchCache();
+        }
+        else
+        {
+            Config::DisableMatchCache();
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++)
+        {
+            std::string node = "/NodeList/" + std::to_string(i % 1000);
+            Config::Set(node + "/DeviceList/" + std::to_string(i % 3) + "/Mtu",
+                        UintegerValue(1000 + i % 500));
+        }
+        auto end = std::chrono::steady_clock::now();
+        std::cout << "us/Config::Set " << (cache ? "(cached)" : "") << ": "
+                  << std::chrono::duration<double, std::micro>(end - start).count() / count
+                  << std::endl;
+    }
+    set = set && network->m_nodes[999]->m_devices[0]->m_mtu == 1000 + 48999 % 500;
+
+    Config::DisableMatchCache();
+    Config::UnregisterRootNamespaceObject(network);
+    Names::Clear();
+    bool ok = resolved && set && cached;
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -20,12 +20,18 @@
 */
 
 
+#include "config.h"
+#include "nsim-string.h"
 #include "nstime.h"
+#include "philox-stream.h"
 #include "random-variable-stream.h"
 #include "rng-seed-manager.h"
+#include "rng-stream.h"
 #include "simulator.h"
 
 #include <iostream>
+#include <thread>
+#include <vector>
 
 
 using namespace nsim2023;
@@ -42,6 +48,86 @@ int main(int argc, char* argv[])
         std::cout << uv->GetValue() << std::endl;
     }
 
+    // A batch draws the same values as repeated GetValue() calls
+    const std::size_t count = 10000;
+    std::vector<double> batch(count);
+    Ptr<ExponentialRandomVariable> scalar = CreateObject<ExponentialRandomVariable>();
+    Ptr<ExponentialRandomVariable> batched = CreateObject<ExponentialRandomVariable>();
+    scalar->SetStream(7);
+    batched->SetStream(7);
+    batched->GetValues(batch.data(), count);
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        mismatches += (batch[i] != scalar->GetValue());
+    }
+    std::cout << "batch mismatches: " << mismatches << std::endl;
+
+    // Philox4x32-10 known answers, from the Random123 distribution
+    const uint32_t counters[3][4] = {{0, 0, 0, 0},
+                                     {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                                     {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}};
+    const uint32_t keys[3][2] = {{0, 0}, {0xffffffff, 0xffffffff}, {0xa4093822, 0x299f31d0}};
+    const uint32_t answers[3][4] = {{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+                                    {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+                                    {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}};
+    mismatches = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        uint32_t result[4];
+        PhiloxStream::Block(counters[i], keys[i], result);
+        for (int j = 0; j < 4; j++)
+        {
+            mismatches += (result[j] != answers[i][j]);
+        }
+    }
+    std::cout << "philox known answer mismatches: " << mismatches << std::endl;
+
+    // With the counter-based engine, any number of a stream can be computed directly
+    Config::SetGlobal("RngEngine", StringValue("Philox4x32"));
+    Ptr<UniformRandomVariable> philox = CreateObject<UniformRandomVariable>();
+    philox->SetStream(3);
+    PhiloxStream direct(1, (1ULL << 63) + 3, 6);
+    mismatches = 0;
+    for (uint64_t i = 0; i < 1000; i++)
+    {
+        mismatches += (philox->GetValue() != direct.GetU01(i));
+    }
+    std::cout << "philox direct access mismatches: " << mismatches << std::endl;
+    Config::SetGlobal("RngEngine", StringValue("MRG32k3a"));
+
+    // Nodes built concurrently in their own partitions get the same streams
+    // as when built alone: the k-th stream of partition p is (p + 1) * 2^32 + k
+    const int nodes = 4;
+    const int perNode = 100;
+    std::vector<double> first(nodes * perNode);
+    std::vector<std::thread> builders;
+    for (int node = 0; node < nodes; node++)
+    {
+        builders.emplace_back([node, &first]() {
+            RngStreamPartition partition(node);
+            for (int k = 0; k < perNode; k++)
+            {
+                Ptr<UniformRandomVariable> v = CreateObject<UniformRandomVariable>();
+                first[node * perNode + k] = v->GetValue();
+            }
+        });
+    }
+    for (std::thread& builder : builders)
+    {
+        builder.join();
+    }
+    mismatches = 0;
+    for (int node = 0; node < nodes; node++)
+    {
+        for (int k = 0; k < perNode; k++)
+        {
+            RngStream expected(1, (node + 1ULL) * (1ULL << 32) + k, 6);
+            mismatches += (first[node * perNode + k] != expected.RandU01());
+        }
+    }
+    std::cout << "partitioned stream mismatches: " << mismatches << std::endl;
+
     return 0;
 }
 
@@ -0,0 +1,208 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+
+#include "int64x64.h"
+#include "nstime.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+using namespace nsim2023;
+
+/**
+ * Benchmark of the int64x64_t multiplication, division and conversion
+ * from double, compared with the reference algorithms (the generic
+ * 128-bit partial products and the bit by bit long division).
+ * The results of both implementations must be identical.
+ */
+
+static const uint128_t MASK_LO = 0xffffffffffffffffULL;
+
+/** Reference multiplication of unsigned Q64.64 values. */
+static uint128_t
+RefUmul(const uint128_t a, const uint128_t b)
+{
+    uint128_t aL = a & MASK_LO;
+    uint128_t bL = b & MASK_LO;
+    uint128_t aH = (a >> 64) & MASK_LO;
+    uint128_t bH = (b >> 64) & MASK_LO;
+    uint128_t loPart = aL * bL;
+    uint128_t midPart = aL * bH + aH * bL;
+    uint128_t hiPart = aH * bH;
+    uint128_t result = (loPart >> 64) + (midPart & MASK_LO);
+    result += ((midPart >> 64) + (hiPart & MASK_LO)) << 64;
+    return result;
+}
+
+/** Reference division of unsigned Q64.64 values. */
+static uint128_t
+RefUdiv(const uint128_t a, const uint128_t b)
+{
+    uint128_t rem = a;
+    uint128_t den = b;
+    uint128_t quo = rem / den;
+    rem = rem % den;
+    uint128_t result = quo;
+    const uint64_t DIGITS = 64;
+    const uint128_t HI_BIT = ((uint128_t)1) << 127;
+    uint64_t digis = 0;
+    uint64_t shift = 0;
+    while ((shift < DIGITS) && !(den & 0x1))
+    {
+        ++shift;
+        den >>= 1;
+    }
+    while ((digis < DIGITS) && (rem != 0))
+    {
+        while ((digis + shift < DIGITS) && !(rem & HI_BIT))
+        {
+            ++shift;
+            rem <<= 1;
+        }
+        while ((digis + shift < DIGITS) && (!(den & 0x1) || (rem < den)))
+        {
+            ++shift;
+            den >>= 1;
+        }
+        quo = rem / den;
+        rem = rem % den;
+        result <<= shift;
+        result += quo;
+        digis += shift;
+        shift = 0;
+    }
+    if (digis < DIGITS)
+    {
+        result <<= DIGITS - digis;
+    }
+    return result;
+}
+
+/** Apply a reference unsigned operation to signed values. */
+static int64x64_t
+RefSigned(const int64x64_t& x, const int64x64_t& y, uint128_t (*op)(uint128_t, uint128_t))
+{
+    int128_t sa = (int128_t)((uint128_t)x.GetHigh() << 64 | x.GetLow());
+    int128_t sb = (int128_t)((uint128_t)y.GetHigh() << 64 | y.GetLow());
+    bool negative = (sa < 0) != (sb < 0);
+    uint128_t r = op(sa < 0 ? -sa : sa, sb < 0 ? -sb : sb);
+    return int64x64_t(negative ? -(int128_t)r : (int128_t)r);
+}
+
+/** Time \p count calls of \p f, and return the ns per call. */
+template <typename F>
+static double
+Measure(uint32_t count, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        f(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / count;
+}
+
+int main(int argc, char* argv[])
+{
+    const uint32_t N = 1 << 16;
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> real(-1e6, 1e6);
+    std::uniform_real_distribution<double> unit(-1, 1);
+    std::uniform_int_distribution<int64_t> integer(-1000000000LL, 1000000000LL);
+
+    // Operands: doubles, pure fractions, integers, and small powers of two
+    std::vector<double> doubles;
+    std::vector<int64x64_t> lhs;
+    std::vector<int64x64_t> rhs;
+    for (uint32_t i = 0; i < N; i++)
+    {
+        double d = (i % 4 == 0) ? real(rng) : (i % 4 == 1) ? unit(rng) * 1e-9 : unit(rng);
+        doubles.push_back(d);
+        lhs.push_back((i % 3 == 0) ? int64x64_t(integer(rng)) : int64x64_t(real(rng)));
+        switch (i % 5)
+        {
+        case 0:
+            rhs.push_back(int64x64_t(unit(rng)));
+            break;
+        case 1:
+            rhs.push_back(int64x64_t(integer(rng) % 1000 + 1001));
+            break;
+        case 2:
+            rhs.push_back(int64x64_t(1.0 / (1 << (i % 20))));
+            break;
+        default:
+            rhs.push_back(int64x64_t(real(rng) / 1000));
+            break;
+        }
+    }
+
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < N; i++)
+    {
+        if (!(int64x64_t(doubles[i]) == int64x64_t((long double)doubles[i])))
+        {
+            errors++;
+        }
+        if (!(lhs[i] * rhs[i] == RefSigned(lhs[i], rhs[i], RefUmul)))
+        {
+            errors++;
+        }
+        if (!(lhs[i] / rhs[i] == RefSigned(lhs[i], rhs[i], RefUdiv)))
+        {
+            errors++;
+        }
+    }
+    std::cout << "mismatches: " << errors << std::endl;
+
+    int64x64_t sink = 0;
+    std::cout << "double conversion, reference: "
+              << Measure(N, [&](uint32_t i) { sink += int64x64_t((long double)doubles[i]); })
+              << " ns" << std::endl;
+    std::cout << "double conversion:            "
+              << Measure(N, [&](uint32_t i) { sink += int64x64_t(doubles[i]); }) << " ns"
+              << std::endl;
+    std::cout << "multiplication, reference:    "
+              << Measure(N, [&](uint32_t i) { sink += RefSigned(lhs[i], rhs[i], RefUmul); })
+              << " ns" << std::endl;
+    std::cout << "multiplication:               "
+              << Measure(N, [&](uint32_t i) { sink += lhs[i] * rhs[i]; }) << " ns" << std::endl;
+    std::cout << "division, reference:          "
+              << Measure(N, [&](uint32_t i) { sink += RefSigned(lhs[i], rhs[i], RefUdiv); })
+              << " ns" << std::endl;
+    std::cout << "division:                     "
+              << Measure(N, [&](uint32_t i) { sink += lhs[i] / rhs[i]; }) << " ns" << std::endl;
+
+    Time t = Seconds(1.0);
+    Time total;
+    std::cout << "Time * double:                "
+              << Measure(N, [&](uint32_t i) { total += t * doubles[i]; }) << " ns" << std::endl;
+    std::cout << "Time / double:                "
+              << Measure(N, [&](uint32_t i) { total += t / (doubles[i] + 2.0); }) << " ns"
+              << std::endl;
+    std::cout << "(" << sink.GetHigh() << " " << total.GetTimeStep() << ")" << std::endl;
+
+    return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+
+#include "double.h"
+#include "integer.h"
+#include "random-variable-stream.h"
+#include "rng-seed-manager.h"
+#include "rng-stream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+
+using namespace nsim2023;
+
+/**
+ * Validation of the gamma and Erlang samplers against the previous
+ * implementations, reproduced below and driven by the same RngStream.
+ * The gamma values must be identical; the Erlang values must be equal up
+ * to rounding for small k and follow the same distribution for large k.
+ */
+
+/** The previous gamma sampler, with its Box-Muller normal values. */
+class RefGamma
+{
+  public:
+    /** Draw from the given stream number. */
+    RefGamma(int64_t stream)
+        : m_rng(RngSeedManager::GetSeed(), (1ULL << 63) + stream, RngSeedManager::GetRun()),
+          m_nextValid(false)
+    {
+    }
+
+    /** The previous GammaRandomVariable::GetValue(). */
+    double GetValue(double alpha, double beta)
+    {
+        if (alpha < 1)
+        {
+            double u = m_rng.RandU01();
+            return GetValue(1.0 + alpha, beta) * std::pow(u, 1.0 / alpha);
+        }
+        double x;
+        double v;
+        double u;
+        double d = alpha - 1.0 / 3.0;
+        double c = (1.0 / 3.0) / std::sqrt(d);
+        while (1)
+        {
+            do
+            {
+                x = GetNormalValue();
+                v = 1.0 + c * x;
+            } while (v <= 0);
+            v = v * v * v;
+            u = m_rng.RandU01();
+            if (u < 1 - 0.0331 * x * x * x * x)
+            {
+                break;
+            }
+            if (std::log(u) < 0.5 * x * x + d * (1 - v + std::log(v)))
+            {
+                break;
+            }
+        }
+        return beta * d * v;
+    }
+
+  private:
+    /** The previous GammaRandomVariable::GetNormalValue(), unbounded. */
+    double GetNormalValue()
+    {
+        if (m_nextValid)
+        {
+            m_nextValid = false;
+            return m_v2 * m_y;
+        }
+        while (1)
+        {
+            double v1 = 2 * m_rng.RandU01() - 1;
+            double v2 = 2 * m_rng.RandU01() - 1;
+            double w = v1 * v1 + v2 * v2;
+            if (w <= 1.0)
+            {
+                m_y = std::sqrt((-2 * std::log(w)) / w);
+                m_v2 = v2;
+                m_nextValid = true;
+                return v1 * m_y;
+            }
+        }
+    }
+
+    RngStream m_rng;  //!< Uniform numbers
+    bool m_nextValid; //!< Second Box-Muller value available
+    double m_v2;      //!< Second Box-Muller value
+    double m_y;       //!< Second Box-Muller value
+};
+
+/** The previous Erlang sampler: a sum of k exponential values. */
+static double
+RefErlang(RngStream& rng, uint32_t k, double lambda)
+{
+    double result = 0;
+    for (uint32_t i = 0; i < k; ++i)
+    {
+        result += -lambda * std::log(rng.RandU01());
+    }
+    return result;
+}
+
+/** Two-sample Kolmogorov-Smirnov statistic, scaled by sqrt(n m / (n + m)). */
+static double
+KolmogorovSmirnov(std::vector<double> a, std::vector<double> b)
+{
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    std::size_t i = 0;
+    std::size_t j = 0;
+    double d = 0;
+    while (i < a.size() && j < b.size())
+    {
+        if (a[i] <= b[j])
+        {
+            i++;
+        }
+        else
+        {
+            j++;
+        }
+        d = std::max(d, std::fabs(double(i) / a.size() - double(j) / b.size()));
+    }
+    double n = a.size();
+    double m = b.size();
+    return d * std::sqrt(n * m / (n + m));
+}
+
+int main(int argc, char* argv[])
+{
+    const int count = 200000;
+    // 1.63 is the 1% critical value of the scaled statistic
+    const double ksCritical = 1.63;
+    bool ok = true;
+
+    for (double alpha : {0.3, 1.0, 2.5, 9.0})
+    {
+        Ptr<GammaRandomVariable> gamma = CreateObject<GammaRandomVariable>();
+        gamma->SetStream(10);
+        RefGamma ref(10);
+        int mismatches = 0;
+        for (int i = 0; i < count; i++)
+        {
+            mismatches += (gamma->GetValue(alpha, 2.0) != ref.GetValue(alpha, 2.0));
+        }
+        std::cout << "gamma alpha=" << alpha << " mismatches: " << mismatches << std::endl;
+        ok = ok && mismatches == 0;
+    }
+
+    for (uint32_t k : {1, 4, 16, 17, 50, 400})
+    {
+        Ptr<ErlangRandomVariable> erlang = CreateObject<ErlangRandomVariable>();
+        erlang->SetAttribute("K", IntegerValue(k));
+        erlang->SetAttribute("Lambda", DoubleValue(0.5));
+        erlang->SetStream(20);
+        RngStream rng(RngSeedManager::GetSeed(), (1ULL << 63) + 20, RngSeedManager::GetRun());
+        // The reference uses an independent stream when the algorithms differ
+        RngStream other(RngSeedManager::GetSeed(), (1ULL << 63) + 21, RngSeedManager::GetRun());
+        std::vector<double> values(count);
+        std::vector<double> refs(count);
+        double maxError = 0;
+        double sum = 0;
+        for (int i = 0; i < count; i++)
+        {
+            values[i] = erlang->GetValue();
+            sum += values[i];
+            if (k <= ErlangRandomVariable::ERLANG_PRODUCT_MAX_K)
+            {
+                refs[i] = RefErlang(rng, k, 0.5);
+                maxError = std::max(maxError, std::fabs(values[i] - refs[i]) / refs[i]);
+            }
+            else
+            {
+                refs[i] = RefErlang(other, k, 0.5);
+            }
+        }
+        double ks = KolmogorovSmirnov(values, refs);
+        std::cout << "erlang k=" << k << " mean " << sum / count << " (expected " << k * 0.5
+                  << ") max relative error " << maxError << " KS " << ks << std::endl;
+        ok = ok && maxError < 1e-12 && ks < ksCritical;
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok ? 0 : 1;
+}
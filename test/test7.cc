@@ -0,0 +1,496 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+
+#include "boolean.h"
+#include "config.h"
+#include "double.h"
+#include "integer.h"
+#include "nsim-string.h"
+#include "random-variable-stream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+using namespace nsim2023;
+
+/**
+ * Benchmark and statistical regression suite of the random variables.
+ *
+ * For every random variable class, and the selectable algorithms of some,
+ * this measures the time per value through GetValue() and through the
+ * batched GetValues(), then checks a fixed sample against the exact
+ * distribution: Kolmogorov-Smirnov for continuous distributions,
+ * chi-square for discrete ones. The streams are fixed, so a failure is a
+ * change of the generated values that moved them away from the expected
+ * distribution, not bad luck. The thresholds are the 0.1% critical values.
+ */
+
+/** Number of values of each statistical check. */
+static const int SAMPLES = 100000;
+/** Number of values of each timing. */
+static const int TIMED = 200000;
+
+/** Standard normal CDF. */
+static double
+NormalCdf(double x)
+{
+    return 0.5 * std::erfc(-x / std::sqrt(2.0));
+}
+
+/** Regularized lower incomplete gamma function P(a, x). */
+static double
+GammaP(double a, double x)
+{
+    if (x <= 0)
+    {
+        return 0;
+    }
+    double prefix = std::exp(-x + a * std::log(x) - std::lgamma(a));
+    if (x < a + 1)
+    {
+        // Series
+        double term = 1.0 / a;
+        double sum = term;
+        for (int n = 1; n < 10000; n++)
+        {
+            term *= x / (a + n);
+            sum += term;
+            if (std::fabs(term) < std::fabs(sum) * 1e-15)
+            {
+                break;
+            }
+        }
+        return sum * prefix;
+    }
+    // Continued fraction for Q(a, x), Lentz's method
+    const double tiny = 1e-300;
+    double b = x + 1 - a;
+    double c = 1 / tiny;
+    double d = 1 / b;
+    double h = d;
+    for (int i = 1; i < 10000; i++)
+    {
+        double an = -i * (i - a);
+        b += 2;
+        d = an * d + b;
+        d = std::fabs(d) < tiny ? tiny : d;
+        c = b + an / c;
+        c = std::fabs(c) < tiny ? tiny : c;
+        d = 1 / d;
+        double delta = d * c;
+        h *= delta;
+        if (std::fabs(delta - 1) < 1e-15)
+        {
+            break;
+        }
+    }
+    return 1 - prefix * h;
+}
+
+/** One random variable configuration under test. */
+struct Case
+{
+    std::string name;                                    //!< Printed name
+    std::function<Ptr<RandomVariableStream>()> create;   //!< Creates the variable
+    std::function<double(double)> cdf;                   //!< Exact CDF, for continuous cases
+    std::function<double(int)> pmf;                      //!< Exact PMF, for discrete cases
+    int minValue;                                        //!< Smallest discrete value
+    int maxValue;                                        //!< Largest discrete value, the rest is one tail bin
+    std::function<double(int)> sequence;                 //!< Exact value i, for deterministic cases
+};
+
+/** Create a random variable of type T with the given attributes. */
+template <class T>
+static std::function<Ptr<RandomVariableStream>()>
+Make(std::vector<std::pair<std::string, std::string>> attributes)
+{
+    return [attributes]() {
+        Ptr<T> rv = CreateObject<T>();
+        for (const auto& attribute : attributes)
+        {
+            rv->SetAttribute(attribute.first, StringValue(attribute.second));
+        }
+        return Ptr<RandomVariableStream>(rv);
+    };
+}
+
+/** Create an empirical random variable over a fixed CDF. */
+static std::function<Ptr<RandomVariableStream>()>
+MakeEmpirical(bool interpolate, bool alias)
+{
+    return [interpolate, alias]() {
+        Ptr<EmpiricalRandomVariable> rv = CreateObject<EmpiricalRandomVariable>();
+        rv->SetAttribute("Interpolate", BooleanValue(interpolate));
+        rv->SetAttribute("Alias", BooleanValue(alias));
+        rv->CDF(0, 0.0);
+        rv->CDF(1, 0.1);
+        rv->CDF(2, 0.15);
+        rv->CDF(3, 0.5);
+        rv->CDF(4, 0.55);
+        rv->CDF(5, 0.9);
+        rv->CDF(6, 1.0);
+        return Ptr<RandomVariableStream>(rv);
+    };
+}
+
+/** CDF points of MakeEmpirical(). */
+static const double EMPIRICAL_CDF[] = {0.0, 0.1, 0.15, 0.5, 0.55, 0.9, 1.0};
+
+/** Create a deterministic random variable over a fixed array. */
+static Ptr<RandomVariableStream>
+MakeDeterministic()
+{
+    Ptr<DeterministicRandomVariable> rv = CreateObject<DeterministicRandomVariable>();
+    double array[] = {4, 4, 7, 7, 10, 10};
+    rv->SetValueArray(array, 6);
+    return rv;
+}
+
+/** Time per value in ns of GetValue() and of GetValues(). */
+static void
+Time(Ptr<RandomVariableStream> rv, double& scalar, double& batch)
+{
+    std::vector<double> values(TIMED);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < TIMED; i++)
+    {
+        values[i] = rv->GetValue();
+    }
+    auto middle = std::chrono::steady_clock::now();
+    rv->GetValues(values.data(), TIMED);
+    auto end = std::chrono::steady_clock::now();
+    scalar = std::chrono::duration<double, std::nano>(middle - start).count() / TIMED;
+    batch = std::chrono::duration<double, std::nano>(end - middle).count() / TIMED;
+}
+
+/**
+ * Time per value in ns of the inline T::Sample(), and the number of its
+ * values that differ from GetValue() on the same stream.
+ */
+template <class T>
+static double
+TimeSample(std::vector<std::pair<std::string, std::string>> attributes, int& mismatches)
+{
+    Ptr<T> rv = DynamicCast<T>(Make<T>(attributes)());
+    Ptr<T> reference = DynamicCast<T>(Make<T>(attributes)());
+    rv->SetStream(50);
+    reference->SetStream(50);
+    std::vector<double> values(TIMED);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < TIMED; i++)
+    {
+        values[i] = rv->Sample();
+    }
+    auto end = std::chrono::steady_clock::now();
+    for (int i = 0; i < TIMED; i++)
+    {
+        mismatches += (values[i] != reference->GetValue());
+    }
+    return std::chrono::duration<double, std::nano>(end - start).count() / TIMED;
+}
+
+/** Scaled one-sample Kolmogorov-Smirnov statistic. */
+static double
+KolmogorovSmirnov(std::vector<double> values, const std::function<double(double)>& cdf)
+{
+    std::sort(values.begin(), values.end());
+    double n = values.size();
+    double d = 0;
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        double f = cdf(values[i]);
+        d = std::max(d, std::max(f - i / n, (i + 1) / n - f));
+    }
+    return d * std::sqrt(n);
+}
+
+/**
+ * Chi-square statistic over minValue..maxValue and a tail bin, and its
+ * critical value. Bins expecting less than 5 values are merged in the tail.
+ */
+static double
+ChiSquare(const std::vector<double>& values, const Case& c, double& critical)
+{
+    std::vector<double> expected;
+    std::vector<double> observed;
+    std::vector<int> bin(c.maxValue + 1, -1);
+    double tailExpected = SAMPLES;
+    for (int v = c.minValue; v <= c.maxValue; v++)
+    {
+        double e = SAMPLES * c.pmf(v);
+        if (e >= 5)
+        {
+            bin[v] = expected.size();
+            expected.push_back(e);
+            observed.push_back(0);
+            tailExpected -= e;
+        }
+    }
+    double tailObserved = 0;
+    for (double value : values)
+    {
+        int v = static_cast<int>(value);
+        if (value == v && v >= c.minValue && v <= c.maxValue && bin[v] >= 0)
+        {
+            observed[bin[v]]++;
+        }
+        else
+        {
+            tailObserved++;
+        }
+    }
+    if (tailExpected >= 5)
+    {
+        expected.push_back(tailExpected);
+        observed.push_back(tailObserved);
+    }
+    else if (tailObserved > 0)
+    {
+        // Values out of the support are always a failure
+        critical = 0;
+        return 1e300;
+    }
+    double chi2 = 0;
+    for (std::size_t i = 0; i < expected.size(); i++)
+    {
+        chi2 += (observed[i] - expected[i]) * (observed[i] - expected[i]) / expected[i];
+    }
+    // Wilson-Hilferty approximation of the 0.1% critical value
+    double df = expected.size() - 1;
+    double z = 3.09;
+    critical = df * std::pow(1 - 2 / (9 * df) + z * std::sqrt(2 / (9 * df)), 3);
+    return chi2;
+}
+
+int main(int argc, char* argv[])
+{
+    const double ksCritical = 1.95;
+
+    const double zipfN = 50;
+    const double zipfAlpha = 1.1;
+    double zipfH = 0;
+    for (int k = 1; k <= zipfN; k++)
+    {
+        zipfH += std::pow(k, -zipfAlpha);
+    }
+    const double zetaAlpha = 3.14;
+    double zeta = 0;
+    for (int k = 1; k <= 1000000; k++)
+    {
+        zeta += std::pow(k, -zetaAlpha);
+    }
+    zeta += std::pow(1000000.5, 1 - zetaAlpha) / (zetaAlpha - 1);
+
+    auto triangular = [](double x) {
+        const double min = 1;
+        const double max = 8;
+        const double mode = 3;
+        if (x <= mode)
+        {
+            return (x - min) * (x - min) / ((max - min) * (mode - min));
+        }
+        return 1 - (max - x) * (max - x) / ((max - min) * (max - mode));
+    };
+    auto empiricalPmf = [](int v) {
+        return v == 0 ? EMPIRICAL_CDF[0] : EMPIRICAL_CDF[v] - EMPIRICAL_CDF[v - 1];
+    };
+    auto empiricalCdf = [](double x) {
+        if (x <= 0)
+        {
+            return 0.0;
+        }
+        int i = std::min(5, static_cast<int>(x));
+        double t = x - i;
+        return EMPIRICAL_CDF[i] + t * (EMPIRICAL_CDF[i + 1] - EMPIRICAL_CDF[i]);
+    };
+    auto none = std::function<double(int)>();
+
+    std::vector<Case> cases = {
+        {"Uniform",
+         Make<UniformRandomVariable>({{"Min", "2"}, {"Max", "5"}}),
+         [](double x) { return (x - 2) / 3; }, none, 0, 0},
+        {"Exponential",
+         Make<ExponentialRandomVariable>({{"Mean", "2"}}),
+         [](double x) { return 1 - std::exp(-x / 2); }, none, 0, 0},
+        {"Exponential bounded",
+         Make<ExponentialRandomVariable>({{"Mean", "2"}, {"Bound", "3"}}),
+         [](double x) { return (1 - std::exp(-x / 2)) / (1 - std::exp(-1.5)); }, none, 0, 0},
+        {"Exponential ziggurat",
+         Make<ExponentialRandomVariable>({{"Mean", "2"}, {"Ziggurat", "true"}}),
+         [](double x) { return 1 - std::exp(-x / 2); }, none, 0, 0},
+        {"Pareto",
+         Make<ParetoRandomVariable>({{"Scale", "1"}, {"Shape", "2"}}),
+         [](double x) { return 1 - std::pow(1 / x, 2); }, none, 0, 0},
+        {"Weibull",
+         Make<WeibullRandomVariable>({{"Scale", "1"}, {"Shape", "1.5"}}),
+         [](double x) { return 1 - std::exp(-std::pow(x, 1.5)); }, none, 0, 0},
+        {"Normal",
+         Make<NormalRandomVariable>({{"Mean", "1"}, {"Variance", "4"}}),
+         [](double x) { return NormalCdf((x - 1) / 2); }, none, 0, 0},
+        {"Normal ziggurat",
+         Make<NormalRandomVariable>({{"Mean", "1"}, {"Variance", "4"}, {"Ziggurat", "true"}}),
+         [](double x) { return NormalCdf((x - 1) / 2); }, none, 0, 0},
+        {"LogNormal",
+         Make<LogNormalRandomVariable>({{"Mu", "0.5"}, {"Sigma", "0.8"}}),
+         [](double x) { return NormalCdf((std::log(x) - 0.5) / 0.8); }, none, 0, 0},
+        {"LogNormal ziggurat",
+         Make<LogNormalRandomVariable>({{"Mu", "0.5"}, {"Sigma", "0.8"}, {"Ziggurat", "true"}}),
+         [](double x) { return NormalCdf((std::log(x) - 0.5) / 0.8); }, none, 0, 0},
+        {"Gamma",
+         Make<GammaRandomVariable>({{"Alpha", "2.5"}, {"Beta", "1.5"}}),
+         [](double x) { return GammaP(2.5, x / 1.5); }, none, 0, 0},
+        {"Gamma alpha < 1",
+         Make<GammaRandomVariable>({{"Alpha", "0.6"}, {"Beta", "1.5"}}),
+         [](double x) { return GammaP(0.6, x / 1.5); }, none, 0, 0},
+        {"Gamma ziggurat",
+         Make<GammaRandomVariable>({{"Alpha", "2.5"}, {"Beta", "1.5"}, {"Ziggurat", "true"}}),
+         [](double x) { return GammaP(2.5, x / 1.5); }, none, 0, 0},
+        {"Erlang",
+         Make<ErlangRandomVariable>({{"K", "3"}, {"Lambda", "0.5"}}),
+         [](double x) { return GammaP(3, x / 0.5); }, none, 0, 0},
+        {"Erlang large k",
+         Make<ErlangRandomVariable>({{"K", "40"}, {"Lambda", "0.5"}}),
+         [](double x) { return GammaP(40, x / 0.5); }, none, 0, 0},
+        {"Triangular",
+         Make<TriangularRandomVariable>({{"Mean", "4"}, {"Min", "1"}, {"Max", "8"}}),
+         triangular, none, 0, 0},
+        {"Empirical interpolated",
+         MakeEmpirical(true, false),
+         empiricalCdf, none, 0, 0},
+        {"Empirical interpolated alias",
+         MakeEmpirical(true, true),
+         empiricalCdf, none, 0, 0},
+        {"Empirical",
+         MakeEmpirical(false, false),
+         nullptr, empiricalPmf, 0, 6},
+        {"Empirical alias",
+         MakeEmpirical(false, true),
+         nullptr, empiricalPmf, 0, 6},
+        {"Zipf",
+         Make<ZipfRandomVariable>({{"N", "50"}, {"Alpha", "1.1"}}),
+         nullptr, [=](int k) { return std::pow(k, -zipfAlpha) / zipfH; }, 1, 50},
+        {"Zeta",
+         Make<ZetaRandomVariable>({{"Alpha", "3.14"}}),
+         nullptr, [=](int k) { return std::pow(k, -zetaAlpha) / zeta; }, 1, 100},
+        {"Constant",
+         Make<ConstantRandomVariable>({{"Constant", "7"}}),
+         nullptr, none, 0, 0, [](int i) { return 7.0; }},
+        {"Sequential",
+         Make<SequentialRandomVariable>({{"Min", "2"},
+                                         {"Max", "14"},
+                                         {"Increment", "nsim2023::ConstantRandomVariable[Constant=4]"},
+                                         {"Consecutive", "3"}}),
+         nullptr, none, 0, 0, [](int i) { return 2.0 + 4 * ((i / 3) % 3); }},
+        {"Deterministic",
+         MakeDeterministic,
+         nullptr, none, 0, 0, [](int i) { return 4.0 + 3 * ((i / 2) % 3); }},
+    };
+
+    bool ok = true;
+    std::cout << std::left << std::setw(30) << "variable" << std::right << std::setw(12)
+              << "scalar ns" << std::setw(12) << "batch ns" << std::setw(12) << "statistic"
+              << std::setw(12) << "critical" << std::endl;
+    int stream = 100;
+    for (const Case& c : cases)
+    {
+        double scalar;
+        double batch;
+        Time(c.create(), scalar, batch);
+
+        Ptr<RandomVariableStream> rv = c.create();
+        rv->SetStream(stream++);
+        std::vector<double> values(SAMPLES);
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            values[i] = rv->GetValue();
+        }
+        double statistic;
+        double critical;
+        if (c.sequence)
+        {
+            // Number of values off the expected sequence
+            statistic = 0;
+            for (int i = 0; i < SAMPLES; i++)
+            {
+                statistic += (values[i] != c.sequence(i));
+            }
+            critical = 0;
+        }
+        else if (c.cdf)
+        {
+            statistic = KolmogorovSmirnov(values, c.cdf);
+            critical = ksCritical;
+        }
+        else
+        {
+            statistic = ChiSquare(values, c, critical);
+        }
+        bool pass = statistic <= critical;
+        ok = ok && pass;
+        std::cout << std::left << std::setw(30) << c.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << scalar << std::setw(12) << batch
+                  << std::setprecision(3) << std::setw(12) << statistic << std::setw(12)
+                  << critical << (pass ? "" : "  FAIL") << std::endl;
+    }
+
+    // The counter-based engine behind the same distributions
+    Config::SetGlobal("RngEngine", StringValue("Philox4x32"));
+    for (std::size_t i : {0, 1, 7})
+    {
+        double scalar;
+        double batch;
+        Time(cases[i].create(), scalar, batch);
+        std::cout << std::left << std::setw(30) << (cases[i].name + " philox") << std::right
+                  << std::setprecision(1) << std::setw(12) << scalar << std::setw(12) << batch
+                  << std::endl;
+    }
+    Config::SetGlobal("RngEngine", StringValue("MRG32k3a"));
+
+    // The inline Sample() of the concrete classes draws the GetValue() values
+    std::vector<std::pair<std::string, double>> samples;
+    int mismatches = 0;
+    samples.emplace_back("Uniform sample", TimeSample<UniformRandomVariable>({}, mismatches));
+    samples.emplace_back("Exponential sample",
+                         TimeSample<ExponentialRandomVariable>({{"Bound", "3"}}, mismatches));
+    samples.emplace_back("Pareto sample",
+                         TimeSample<ParetoRandomVariable>({{"Bound", "10"}}, mismatches));
+    samples.emplace_back("Weibull sample", TimeSample<WeibullRandomVariable>({}, mismatches));
+    samples.emplace_back("Triangular sample",
+                         TimeSample<TriangularRandomVariable>({}, mismatches));
+    for (const auto& sample : samples)
+    {
+        std::cout << std::left << std::setw(30) << sample.first << std::right
+                  << std::setprecision(1) << std::setw(12) << sample.second << std::endl;
+    }
+    std::cout << "sample mismatches: " << mismatches << std::endl;
+    ok = ok && mismatches == 0;
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok ? 0 : 1;
+}
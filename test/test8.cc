@@ -0,0 +1,389 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#include "fatal-error.h"
+#include "log.h"
+#include "nstime.h"
+#include "simulator.h"
+
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE("LogTest");
+
+using namespace nsim2023;
+
+/**
+ * Checks that the asynchronous log backend prints what the synchronous
+ * macros print, that LogFormat prints what std::ostream prints, checks the sampling and rate limiting of a component and the
+ * flight recorder, and measures the cost of a log statement with both backends.
+ */
+
+/** A pointer printed by the statements. */
+static int g_object;
+
+/** Statements of every kind, with the values the backend stores in binary or as text. */
+static void
+Emit(int i)
+{
+    NS_LOG_FUNCTION(&g_object << i << "text" << 2.5 << static_cast<uint8_t>(7)
+                              << std::string("string") << std::vector<int>({1, 2}));
+    NS_LOG_FUNCTION_NOARGS();
+    // Manipulators are reset, as they would stay on std::clog otherwise
+    NS_LOG_DEBUG("value " << i << " hex " << std::hex << 255 << " third " << 1.0 / 3 << ' '
+                          << true << " " << -7L << std::dec);
+    NS_LOG_INFO("[" << std::setw(6) << i << "] " << std::setprecision(3) << 3.14159
+                    << std::setprecision(6));
+    NS_LOG_LOGIC("at " << Seconds(i) << " pointer " << &g_object);
+    NS_LOG_WARN('c' << 12345678901234ULL << " " << 1e300 << " " << 2.5f << " " << -0.0);
+}
+
+/** Run the same events and return the log output. */
+static std::string
+Scenario()
+{
+    std::ostringstream output;
+    std::streambuf* clog = std::clog.rdbuf(output.rdbuf());
+    Emit(-1);
+    for (int i = 0; i < 20; i++)
+    {
+        Simulator::ScheduleWithContext(i % 3, MilliSeconds(i * 7), &Emit, i);
+    }
+    Simulator::Run();
+    Simulator::Destroy();
+    LogAsyncFlush();
+    std::clog.rdbuf(clog);
+    return output.str();
+}
+
+/** Format a value with std::ostream. */
+template <typename T>
+static std::string
+Stream(const T& value)
+{
+    std::ostringstream os;
+    os << value;
+    return os.str();
+}
+
+/** Check LogFormat against std::ostream, and its time steps against PrintTimeStep. */
+static bool
+Formats()
+{
+    int mismatches = 0;
+    auto check = [&mismatches](const std::string& formatted, const std::string& expected) {
+        if (formatted != expected && mismatches++ < 10)
+        {
+            std::cout << "formatted " << formatted << " instead of " << expected << std::endl;
+        }
+    };
+    std::string out;
+    for (double value : {0.0,
+                         -0.0,
+                         1.0 / 3,
+                         -2.5,
+                         1e300,
+                         -2.5e-300,
+                         123456789.0,
+                         100000.0,
+                         999999.5,
+                         1e-5,
+                         0.0001,
+                         std::numeric_limits<double>::infinity(),
+                         std::numeric_limits<double>::quiet_NaN(),
+                         std::numeric_limits<double>::denorm_min()})
+    {
+        out.clear();
+        LogFormat::AppendDouble(out, value);
+        check(out, Stream(value));
+    }
+    for (int64_t value : {std::numeric_limits<int64_t>::min(),
+                          std::numeric_limits<int64_t>::max(),
+                          int64_t(0),
+                          int64_t(-1)})
+    {
+        out.clear();
+        LogFormat::AppendSigned(out, value);
+        check(out, Stream(value));
+    }
+    out.clear();
+    LogFormat::AppendUnsigned(out, std::numeric_limits<uint64_t>::max());
+    check(out, Stream(std::numeric_limits<uint64_t>::max()));
+    for (const void* value : {static_cast<const void*>(nullptr), static_cast<const void*>(&g_object)})
+    {
+        out.clear();
+        LogFormat::AppendPointer(out, value);
+        check(out, Stream(value));
+    }
+
+    // Runs of close steps, which rewrite the cached digits, and steps of
+    // any magnitude and sign
+    std::mt19937_64 rng(1);
+    std::vector<int64_t> steps;
+    for (int64_t start : {int64_t(0), int64_t(-3000), int64_t(999999000), int64_t(-1000000500),
+                          (int64_t(1) << 50) - 3000, -(int64_t(1) << 50) - 3000})
+    {
+        for (int64_t step = start; step < start + 6000; step += 7)
+        {
+            steps.push_back(step);
+        }
+    }
+    for (int i = 0; i < 100000; i++)
+    {
+        int64_t step = static_cast<int64_t>(rng() >> (rng() % 64));
+        steps.push_back(step);
+        steps.push_back(step);
+        steps.push_back(step + 1);
+    }
+    steps.push_back(std::numeric_limits<int64_t>::min());
+    for (int64_t step : steps)
+    {
+        out.clear();
+        LogFormat::AppendTimeStep(out, step);
+        std::ostringstream os;
+        PrintTimeStep(os, step);
+        check(out, os.str());
+    }
+    std::cout << "formats " << (mismatches == 0 ? "match" : "differ") << ", "
+              << steps.size() << " time steps" << std::endl;
+    return mismatches == 0;
+}
+
+/** Logic statements with a time prefix. */
+static void
+Burst(int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        NS_LOG_LOGIC("packet " << i << " size " << 1500 << " delay " << 0.25 * i);
+    }
+}
+
+/** Debug and warning statements, one per call. */
+static void
+Tick(int i)
+{
+    NS_LOG_DEBUG("tick " << i);
+    NS_LOG_WARN("warn " << i);
+}
+
+/** Count the lines of \p text that contain \p word. */
+static int
+CountLines(const std::string& text, const std::string& word)
+{
+    std::istringstream lines(text);
+    std::string line;
+    int count = 0;
+    while (std::getline(lines, line))
+    {
+        count += (line.find(word) != std::string::npos);
+    }
+    return count;
+}
+
+/**
+ * Run Tick() 100 times over 10 simulated seconds and count the printed
+ * debug and warning lines.
+ */
+static void
+Ticks(int& debug, int& warn)
+{
+    std::ostringstream output;
+    std::streambuf* clog = std::clog.rdbuf(output.rdbuf());
+    for (int i = 0; i < 100; i++)
+    {
+        Simulator::Schedule(MilliSeconds(i * 100), &Tick, i);
+    }
+    Simulator::Run();
+    Simulator::Destroy();
+    std::clog.rdbuf(clog);
+    debug = CountLines(output.str(), "tick");
+    warn = CountLines(output.str(), "warn");
+}
+
+/**
+ * Check the flight recorder: nothing is written until the dump, which
+ * holds the latest records; and a fatal error dumps them too.
+ */
+static bool
+FlightRecorder()
+{
+    std::ostringstream output;
+    std::streambuf* clog = std::clog.rdbuf(output.rdbuf());
+    LogEnableFlightRecorder(4096);
+    for (int i = 0; i < 1000; i++)
+    {
+        NS_LOG_DEBUG("event " << i);
+    }
+    bool silent = output.str().empty();
+    LogAsyncFlush();
+    std::string dump = output.str();
+    LogDisableAsync();
+    std::clog.rdbuf(clog);
+    int kept = CountLines(dump, "event");
+    bool latest = dump.find("--- flight recorder") == 0 &&
+                  dump.find("event 999\n") == dump.size() - 10 && kept > 10 && kept < 1000;
+
+    // A child process dies on NS_FATAL_ERROR, with the recorder on
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return false;
+    }
+    pid_t child = fork();
+    if (child == 0)
+    {
+        dup2(fds[1], STDERR_FILENO);
+        LogEnableFlightRecorder(4096);
+        for (int i = 0; i < 1000; i++)
+        {
+            NS_LOG_DEBUG("event " << i);
+        }
+        NS_FATAL_ERROR("crash");
+    }
+    close(fds[1]);
+    std::string crash;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+    {
+        crash.append(buffer, n);
+    }
+    close(fds[0]);
+    int status;
+    waitpid(child, &status, 0);
+    bool dumped = crash.find("msg=\"crash\"") != std::string::npos &&
+                  crash.find("event 999\n") != std::string::npos &&
+                  crash.find("event 0\n") == std::string::npos;
+    std::cout << "flight recorder kept " << kept << " records" << (silent ? "" : ", not silent")
+              << (latest ? "" : ", not the latest") << (dumped ? "" : ", not dumped on crash")
+              << std::endl;
+    return silent && latest && dumped;
+}
+
+/** CPU time of the calling thread in ns. */
+static double
+ThreadCpuNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Time per statement in ns, with the output going to a file. \p capture
+ * gets the CPU time of the simulation thread alone; the result is the wall
+ * clock time, including the rendering of the pending records.
+ */
+static double
+TimeBurst(bool async, double& capture)
+{
+    const int count = 200000;
+    std::ofstream sink("/dev/null");
+    std::streambuf* clog = std::clog.rdbuf(sink.rdbuf());
+    if (async)
+    {
+        // Large enough for the burst
+        LogEnableAsync(64 << 20);
+    }
+    auto start = std::chrono::steady_clock::now();
+    double cpuStart = ThreadCpuNs();
+    Simulator::Schedule(Seconds(1), &Burst, count);
+    Simulator::Run();
+    capture = (ThreadCpuNs() - cpuStart) / count;
+    if (async)
+    {
+        LogDisableAsync();
+    }
+    auto end = std::chrono::steady_clock::now();
+    Simulator::Destroy();
+    std::clog.rdbuf(clog);
+    return std::chrono::duration<double, std::nano>(end - start).count() / count;
+}
+
+int main(int argc, char* argv[])
+{
+    LogComponentEnable("LogTest", LogLevel(LOG_LEVEL_ALL | LOG_PREFIX_ALL));
+
+    std::string sync = Scenario();
+    LogEnableAsync();
+    std::string async = Scenario();
+    LogDisableAsync();
+    bool same = (sync == async) && !sync.empty();
+    std::cout << "async output " << (same ? "matches" : "differs") << ", " << sync.size()
+              << " bytes" << std::endl;
+    if (!same)
+    {
+        std::cout << "--- sync\n" << sync << "--- async\n" << async;
+    }
+
+    // Sampling and rate limiting spare the warnings
+    LogComponentDisable("LogTest", LogLevel(LOG_LEVEL_ALL | LOG_PREFIX_ALL));
+    LogComponentEnable("LogTest", LOG_LEVEL_DEBUG);
+    LogComponent& component = GetLogComponent("LogTest");
+    int debug;
+    int warn;
+    component.SetSampling(10);
+    Ticks(debug, warn);
+    bool sampled = (debug == 10 && warn == 100);
+    component.SetSampling(0);
+    component.SetRateLimit(3);
+    Ticks(debug, warn);
+    sampled = sampled && (debug == 30 && warn == 100);
+    component.SetRateLimit(0);
+    Ticks(debug, warn);
+    sampled = sampled && (debug == 100 && warn == 100);
+    // The same through NS_LOG
+    setenv("NS_LOG", "LogTestEnv=debug|sample=4|rate=7", 1);
+    LogComponent fromEnv("LogTestEnv", __FILE__);
+    sampled = sampled && fromEnv.IsEnabled(LOG_DEBUG) && fromEnv.GetSampling() == 4 &&
+              fromEnv.GetRateLimit() == 7;
+    unsetenv("NS_LOG");
+    std::cout << "sampling " << (sampled ? "works" : "fails") << std::endl;
+
+    bool formats = Formats();
+
+    bool flight = FlightRecorder();
+
+    LogComponentDisable("LogTest", LOG_LEVEL_ALL);
+    LogComponentEnable("LogTest", LogLevel(LOG_LOGIC | LOG_PREFIX_TIME | LOG_PREFIX_NODE));
+    double syncCapture;
+    double asyncCapture;
+    double syncNs = TimeBurst(false, syncCapture);
+    double asyncNs = TimeBurst(true, asyncCapture);
+    std::cout << std::fixed << std::setprecision(1) << "ns/statement on the simulation thread: sync "
+              << syncCapture << ", async " << asyncCapture << "; wall clock: sync " << syncNs
+              << ", async " << asyncNs << std::endl;
+
+    bool ok = same && formats && sampled && flight;
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,318 @@
+/*
+    Copyright © 2023 <Pingzhou Ming>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the “Software”), to deal in 
+    the Software without restriction, including without limitation the rights to use, 
+    copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, 
+    and to permit persons to whom the Software is furnished to do so, subject to the 
+    following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies 
+    or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL 
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN 
+    THE SOFTWARE.
+*/
+
+#include "config.h"
+#include "double.h"
+#include "nsim-string.h"
+#include "object-arena.h"
+#include "object-factory.h"
+#include "object.h"
+#include "pointer.h"
+#include "random-variable-stream.h"
+#include "simulator.h"
+#include "trace-source-accessor.h"
+#include "traced-callback.h"
+#include "uinteger.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace nsim2023;
+
+/**
+ * Checks the attributes set by ObjectBase::ConstructSelf: initial values,
+ * NS_ATTRIBUTE_DEFAULT, Config::SetDefault and construction arguments, and
+ * measures the time to create an object.
+ */
+
+/** A model with attributes of every origin. */
+class Model : public Object
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    double m_rate;                          //!< Typed initial value
+    uint32_t m_size;                        //!< Initial value converted from a string
+    uint32_t m_count;                       //!< Set by NS_ATTRIBUTE_DEFAULT
+    Ptr<RandomVariableStream> m_variable;   //!< A new object for every model
+    TracedCallback<double> m_changed;       //!< A trace source
+};
+
+NS_OBJECT_ENSURE_REGISTERED(Model);
+
+TypeId
+Model::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("nsim2023::Model")
+            .SetParent<Object>()
+            .AddConstructor<Model>()
+            .AddAttribute("Rate",
+                          "A rate.",
+                          DoubleValue(1.5),
+                          MakeDoubleAccessor(&Model::m_rate),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("Size",
+                          "A size.",
+                          StringValue("42"),
+                          MakeUintegerAccessor(&Model::m_size),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("Count",
+                          "A count.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&Model::m_count),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("Variable",
+                          "A random variable.",
+                          StringValue("nsim2023::ConstantRandomVariable[Constant=2]"),
+                          MakePointerAccessor(&Model::m_variable),
+                          MakePointerChecker<RandomVariableStream>())
+            .AddTraceSource("Changed",
+                            "The rate changed.",
+                            MakeTraceSourceAccessor(&Model::m_changed),
+                            "nsim2023::Model::RateCallback");
+    return tid;
+}
+
+/** An object aggregated to the models. */
+class Extra : public Object
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+};
+
+NS_OBJECT_ENSURE_REGISTERED(Extra);
+
+TypeId
+Extra::GetTypeId()
+{
+    static TypeId tid = TypeId("nsim2023::Extra").SetParent<Object>().AddConstructor<Extra>();
+    return tid;
+}
+
+/**
+ * Create \p count models with an aggregate, then release them.
+ * \param [in] count The number of models.
+ * \param [out] create The time to create a model, in ns.
+ * \param [out] release The time to release a model, in ns.
+ */
+static void
+TimeModels(int count, double& create, double& release)
+{
+    std::vector<Ptr<Model>> models;
+    models.reserve(count);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        Ptr<Model> model = CreateObject<Model>();
+        model->AggregateObject(CreateObject<Extra>());
+        models.push_back(model);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    models.clear();
+    Simulator::Destroy();
+    auto end = std::chrono::steady_clock::now();
+    create = std::chrono::duration<double, std::nano>(middle - start).count() / count;
+    release = std::chrono::duration<double, std::nano>(end - middle).count() / count;
+}
+
+/** Check the ObjectArena and compare it with the heap. */
+static bool
+Arena()
+{
+    ObjectArena::Enable();
+    Ptr<Model> first = CreateObject<Model>();
+    first->AggregateObject(CreateObject<Extra>());
+    Ptr<Model> second = CreateObject<Model>();
+    // Side by side, apart from the aggregates
+    auto distance = reinterpret_cast<char*>(PeekPointer(second)) -
+                    reinterpret_cast<char*>(PeekPointer(first));
+    bool together = distance > 0 && distance < 1024 && ObjectArena::GetChunkN() == 1;
+    // A freed block is reused
+    Model* address = PeekPointer(second);
+    second = nullptr;
+    second = CreateObject<Model>();
+    bool reused = PeekPointer(second) == address;
+    // The objects outlive the arena
+    Simulator::Destroy();
+    bool released = ObjectArena::GetChunkN() == 0 && first->GetObject<Extra>() &&
+                    first->m_rate == 4.0;
+    first = nullptr;
+    second = nullptr;
+
+    const int count = 100000;
+    double arenaCreate;
+    double arenaRelease;
+    TimeModels(count, arenaCreate, arenaRelease);
+    ObjectArena::Disable();
+    double heapCreate;
+    double heapRelease;
+    TimeModels(count, heapCreate, heapRelease);
+    std::cout << "ns/model with an aggregate, heap: create " << heapCreate << ", release "
+              << heapRelease << "; arena: create " << arenaCreate << ", release " << arenaRelease
+              << std::endl;
+    bool ok = together && reused && released && !ObjectArena::IsEnabled();
+    std::cout << "arena " << (ok ? "works" : "fails") << std::endl;
+    return ok;
+}
+
+/** Check GetObject on aggregates and measure it. */
+static bool
+Aggregates()
+{
+    Ptr<Model> model = CreateObject<Model>();
+    Ptr<Extra> extra = CreateObject<Extra>();
+    Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable>();
+    model->AggregateObject(extra);
+    model->AggregateObject(uniform);
+    model->AggregateObject(CreateObject<ExponentialRandomVariable>());
+    bool found = model->GetObject<Extra>() == extra && extra->GetObject<Model>() == model &&
+                 uniform->GetObject<Extra>() == extra &&
+                 model->GetObject<RandomVariableStream>() == uniform &&
+                 model->GetObject<Object>(Extra::GetTypeId()) == extra;
+    // A miss is remembered until the aggregation changes
+    bool missing = !model->GetObject<ConstantRandomVariable>() &&
+                   !extra->GetObject<ConstantRandomVariable>();
+    Ptr<ConstantRandomVariable> constant = CreateObject<ConstantRandomVariable>();
+    extra->AggregateObject(constant);
+    bool added = model->GetObject<ConstantRandomVariable>() == constant &&
+                 constant->GetObject<Model>() == model && model->GetObject<Extra>() == extra;
+
+    const int count = 10000000;
+    auto start = std::chrono::steady_clock::now();
+    uintptr_t sum = 0;
+    for (int i = 0; i < count; i++)
+    {
+        sum += reinterpret_cast<uintptr_t>(PeekPointer(model->GetObject<ConstantRandomVariable>()));
+        sum += reinterpret_cast<uintptr_t>(PeekPointer(constant->GetObject<Extra>()));
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "ns/GetObject: "
+              << std::chrono::duration<double, std::nano>(end - start).count() / (2 * count)
+              << std::endl;
+    bool ok = found && missing && added && sum != 0;
+    std::cout << "aggregates " << (ok ? "found" : "lost") << std::endl;
+    return ok;
+}
+
+/** Check attribute and trace source lookups by name and measure them. */
+static bool
+Lookups()
+{
+    TypeId uniform = UniformRandomVariable::GetTypeId();
+    TypeId::AttributeInformation info;
+    bool found = uniform.LookupAttributeByName("Min", &info) && info.name == "Min" &&
+                 uniform.LookupAttributeByName("Stream", &info) && info.name == "Stream" &&
+                 !uniform.LookupAttributeByName("Rate", &info) &&
+                 !uniform.LookupAttributeByName("NoSuchName", &info) &&
+                 Model::GetTypeId().LookupTraceSourceByName("Changed") &&
+                 !Model::GetTypeId().LookupTraceSourceByName("Rate");
+    // Names added after a lookup, to a type and to its parent
+    TypeId late = TypeId("nsim2023::LateModel").SetParent<Model>();
+    bool before = late.LookupAttributeByName("Count", &info) && info.name == "Count" &&
+                  !late.LookupAttributeByName("Late", &info);
+    late.AddAttribute("Late",
+                      "An attribute added late.",
+                      UintegerValue(3),
+                      MakeUintegerAccessor(&Model::m_count),
+                      MakeUintegerChecker<uint32_t>());
+    bool after = late.LookupAttributeByName("Late", &info) && info.name == "Late" &&
+                 late.LookupAttributeByName("Rate", &info) &&
+                 late.LookupTraceSourceByName("Changed") &&
+                 !Model::GetTypeId().LookupAttributeByName("Late", &info);
+
+    const int count = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    int hits = 0;
+    for (int i = 0; i < count; i++)
+    {
+        hits += uniform.LookupAttributeByName("Stream", &info);
+        hits += uniform.LookupAttributeByName("Max", &info);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "ns/LookupAttributeByName: "
+              << std::chrono::duration<double, std::nano>(end - start).count() / (2 * count)
+              << std::endl;
+    bool ok = found && before && after && hits == 2 * count;
+    std::cout << "lookups " << (ok ? "found" : "lost") << std::endl;
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    // Read once, when the first object is constructed
+    setenv("NS_ATTRIBUTE_DEFAULT", "nsim2023::Model::Count=9", 1);
+
+    Ptr<Model> first = CreateObject<Model>();
+    Ptr<Model> second = CreateObject<Model>();
+    bool initial = first->m_rate == 1.5 && first->m_size == 42 && first->m_count == 9 &&
+                   first->m_variable && first->m_variable->GetValue() == 2 &&
+                   first->m_variable != second->m_variable;
+    std::cout << "initial values " << (initial ? "set" : "wrong") << std::endl;
+
+    Config::SetDefault("nsim2023::Model::Rate", DoubleValue(4.0));
+    Config::SetDefault("nsim2023::Model::Size", UintegerValue(7));
+    Ptr<Model> changed = CreateObject<Model>();
+    bool defaults = changed->m_rate == 4.0 && changed->m_size == 7 && changed->m_count == 9;
+    std::cout << "defaults " << (defaults ? "follow" : "ignore") << " Config::SetDefault"
+              << std::endl;
+
+    ObjectFactory factory("nsim2023::Model");
+    factory.Set("Rate", DoubleValue(8.0));
+    factory.Set("Count", StringValue("5"));
+    Ptr<Model> argument = factory.Create<Model>();
+    bool arguments = argument->m_rate == 8.0 && argument->m_count == 5 && argument->m_size == 7;
+    std::cout << "arguments " << (arguments ? "override" : "lost") << std::endl;
+
+    // Typed defaults only: objects of a random variable
+    Config::SetDefault("nsim2023::Model::Variable", PointerValue(first->m_variable));
+    const int count = 100000;
+    std::vector<Ptr<Model>> models;
+    models.reserve(count);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        models.push_back(CreateObject<Model>());
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "ns/CreateObject: "
+              << std::chrono::duration<double, std::nano>(end - start).count() / count
+              << std::endl;
+
+    bool arena = Arena();
+    bool aggregates = Aggregates();
+    bool lookups = Lookups();
+
+    bool ok = initial && defaults && arguments && models.back()->m_variable == first->m_variable &&
+              arena && aggregates && lookups;
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok ? 0 : 1;
+}